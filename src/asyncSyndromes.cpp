@@ -0,0 +1,44 @@
+#include "asyncSyndromes.h"
+
+#include <stdexcept>
+
+AsyncSyndromes::AsyncSyndromes(const matrix& h) : m_start(std::chrono::steady_clock::now()) {
+    std::promise<SyndromeData> promise;
+    m_result = promise.get_future().share();
+    m_thread = std::jthread([this, h, promise = std::move(promise)](std::stop_token stop) mutable {
+        try {
+            SyndromeData data;
+            data.syndromes = calculateSyndromes(h, stop, &m_progress);
+            // incomplete syndromes have no table, decoding with them would read out of its bounds
+            if (stop.stop_requested()) throw std::runtime_error("syndrome generation was cancelled");
+            LocalSyndromeTable local = makeLocalSyndromeTable(data.syndromes, h);
+            data.table = std::move(local.table);
+            data.tableH = local.h;
+            data.tableHTransposed = local.h.transpose();
+            promise.set_value(std::move(data));
+        } catch (...) {
+            // e.g. not enough memory for syndromes or cancelled generation, rethrown by get()
+            promise.set_exception(std::current_exception());
+        }
+    });
+}
+
+bool AsyncSyndromes::ready() const {
+    return m_result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+const SyndromeData& AsyncSyndromes::get() const {
+    return m_result.get();
+}
+
+void AsyncSyndromes::cancel() {
+    m_thread.request_stop();
+}
+
+double AsyncSyndromes::etaSeconds() const {
+    size_t found = m_progress.found;
+    size_t total = m_progress.total;
+    if (found == 0 || total == 0) return -1;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    return elapsed * (total - found) / found;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include "math.h"
+#include "encoder.h"
+#include "batchDecoder.h"
+
+// Syndromes in both forms used for decoding.
+struct SyndromeData {
+    Syndromes syndromes;
+    SyndromeTable table; // dense copy of syndromes reordered for cache locality, used for batch decoding
+    matrix tableH; // control matrix whose syndromes index table (see localizeSyndromeTable)
+    matrix tableHTransposed; // tableH transposed, for decoding single vectors (see decodeWithTable)
+};
+
+// Generates syndromes in a background thread, so work that doesn't need them (encoding, sending unencoded data)
+// can start right away. Generation is cancelled when the object is destroyed.
+class AsyncSyndromes {
+public:
+    // Starts generating syndromes.
+    // args:
+    //   h - control matrix.
+    explicit AsyncSyndromes(const matrix& h);
+
+    // Returns true if syndromes are generated (or generation was cancelled).
+    // returns:
+    //   bool - true if get() won't wait.
+    bool ready() const;
+
+    // Waits until syndromes are generated and returns them.
+    // Throws std::runtime_error if generation was cancelled, or the exception generation failed with (e.g. std::bad_alloc).
+    // returns:
+    //   const SyndromeData& - generated syndromes.
+    const SyndromeData& get() const;
+
+    // Requests generation to stop. Does not wait for it.
+    void cancel();
+
+    // Returns progress of generation.
+    // returns:
+    //   const SyndromeProgress& - progress of generation.
+    const SyndromeProgress& progress() const { return m_progress; }
+
+    // Estimates time left until all syndromes are found, from the rate they were found so far.
+    // Later syndromes need heavier error vectors, so the real time is usually longer.
+    // returns:
+    //   double - estimated time left in seconds, or -1 if nothing is known yet.
+    double etaSeconds() const;
+
+private:
+    SyndromeProgress m_progress;
+    std::chrono::steady_clock::time_point m_start;
+    std::shared_future<SyndromeData> m_result;
+    std::jthread m_thread; // declared last, so it is stopped and joined before other members are destroyed
+};
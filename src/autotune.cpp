@@ -0,0 +1,295 @@
+#include "autotune.h"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <chrono>
+#include <sstream>
+#include <functional>
+#include <filesystem>
+
+#include "channel.h"
+
+// size of random workload, and how many of its vectors are checked against reference decoders
+constexpr size_t workloadSize = 4096;
+constexpr size_t verifyCount = 64;
+// every implementation is timed on chunks of workload until the whole workload is done or time is up
+constexpr size_t chunkSize = 64;
+constexpr double timeBudgetMs = 10.0;
+constexpr size_t measureRuns = 3;
+// error probability of workload, errors make decoders do their full work
+constexpr double workloadErrorRate = 0.05;
+
+// Adds bytes of value to FNV-1a hash.
+static void hashValue(uint64_t& hash, uint64_t value) {
+    for (size_t i = 0; i < sizeof(value); i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 0x100000001B3ULL;
+    }
+}
+
+// Computes cache key of a decision. Speed of implementations depends on code size and CPU, not on G,
+// so codes of the same size share decisions.
+// args:
+//   params - common parameters of code.
+//   what - what is tuned: "batch", "ml" or "encode".
+// returns:
+//   uint64_t - FNV-1a hash.
+static uint64_t tuningKey(const CommonParams& params, std::string_view what) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hashValue(hash, params.n);
+    hashValue(hash, params.k);
+    for (char c : what) hashValue(hash, static_cast<uint8_t>(c));
+    hashValue(hash, static_cast<uint64_t>(detectSimdLevel()));
+    return hash;
+}
+
+// Finds instruction set by name.
+static std::optional<SimdLevel> simdLevelFromName(std::string_view name) {
+    for (SimdLevel level : { SimdLevel::scalar, SimdLevel::avx2, SimdLevel::avx512 }) {
+        if (simdLevelName(level) == name) return level;
+    }
+    return std::nullopt;
+}
+
+// Reads cached decision. Every line of cache is "<key> <batch|ml|encode> <choice>",
+// where choice is instruction set for decoders and "cyclic" or "matrix" for encoding.
+// returns:
+//   std::optional<std::string> - cached choice, empty if it is not in cache.
+static std::optional<std::string> readCachedChoice(std::string_view cachePath, uint64_t key, std::string_view what) {
+    std::ifstream file{ std::string(cachePath) };
+    std::string line;
+    std::string wanted = std::format("{:016x}", key);
+    std::optional<std::string> result;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string keyText, whatText, choice;
+        if (fields >> keyText >> whatText >> choice && keyText == wanted && whatText == what) result = choice;
+    }
+    return result;
+}
+
+// Appends decision to cache.
+static void writeCachedChoice(std::string_view cachePath, uint64_t key, std::string_view what, std::string_view choice) {
+    std::ofstream file{ std::string(cachePath), std::ios::app };
+    file << std::format("{:016x} {} {}\n", key, what, choice);
+}
+
+// Runs fn on chunks of input until whole input is processed or time budget is used up.
+// First chunk is run once before timing, to warm up caches. Best of a few runs is taken, to filter out noise.
+// args:
+//   input - vectors to process.
+//   output - results, same size as input.
+//   fn - callable that processes a chunk (input span, output span).
+// returns:
+//   double - processed vectors per second.
+template <typename Fn>
+static double measureThroughput(std::span<const vec> input, std::span<vec> output, Fn&& fn) {
+    fn(input.first(chunkSize), output.first(chunkSize));
+    double best = 0;
+    for (size_t run = 0; run < measureRuns; run++) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        double elapsedMs = 0;
+        size_t done = 0;
+        while (done < input.size() && elapsedMs < timeBudgetMs) {
+            size_t size = std::min(chunkSize, input.size() - done);
+            fn(input.subspan(done, size), output.subspan(done, size));
+            done += size;
+            elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        }
+        best = std::max(best, done / (elapsedMs / 1000.0));
+    }
+    return best;
+}
+
+// Generates random received words of a code: random messages, encoded and sent through channel.
+// Same key always gives the same words, so every implementation gets the same workload.
+// args:
+//   params - common parameters of code.
+//   key - seed of messages and channel.
+// returns:
+//   std::vector<vec> - workloadSize received words.
+static std::vector<vec> randomWorkload(const CommonParams& params, uint64_t key) {
+    std::mt19937_64 generator(key);
+    Channel channel(key);
+    vec messageMask = params.k == 64 ? ~vec{0} : (vec{1} << params.k) - 1;
+    std::vector<vec> received(workloadSize);
+    for (vec& r : received) r = channel.sendVector(encode(generator() & messageMask, params.gTransposed), params.n, workloadErrorRate);
+    return received;
+}
+
+// Picks encoding of cyclic code: polynomial division or G.
+static void autotuneEncoder(CommonParams& params, std::string_view cachePath) {
+    if (!params.cyclic) return;
+    uint64_t key = tuningKey(params, "encode");
+    if (std::optional<std::string> cached = readCachedChoice(cachePath, key, "encode")) {
+        params.cyclicEncode = *cached == "cyclic";
+        std::print("Kodavimo budas paimtas is '{}': {}\n", cachePath, params.cyclicEncode ? "g(x)" : "G");
+        return;
+    }
+
+    std::mt19937_64 generator(key);
+    vec messageMask = params.k == 64 ? ~vec{0} : (vec{1} << params.k) - 1;
+    std::vector<vec> messages(workloadSize), encoded(workloadSize), output(workloadSize);
+    for (vec& message : messages) message = generator() & messageMask;
+    double matrixThroughput = measureThroughput(messages, encoded, [&](std::span<const vec> in, std::span<vec> out) {
+        for (size_t i = 0; i < in.size(); i++) out[i] = encode(in[i], params.gTransposed);
+    });
+    double cyclicThroughput = measureThroughput(messages, output, [&](std::span<const vec> in, std::span<vec> out) {
+        for (size_t i = 0; i < in.size(); i++) out[i] = params.cyclic->encode(in[i]);
+    });
+    bool identical = std::equal(output.begin(), output.begin() + verifyCount, encoded.begin());
+    std::print("Derinamas kodavimas (n={}, k={}):\n", params.n, params.k);
+    std::print("  {:>14}: {:10.3f} Mvec/s\n", "kodavimas G", matrixThroughput / 1e6);
+    std::print("  {:>14}: {:10.3f} Mvec/s{}\n", "kodavimas g(x)", cyclicThroughput / 1e6, identical ? "" : " (rezultatai nesutampa, praleidziama)");
+    params.cyclicEncode = identical && cyclicThroughput > matrixThroughput;
+    writeCachedChoice(cachePath, key, "encode", params.cyclicEncode ? "cyclic" : "matrix");
+}
+
+// Picks instruction set of the decoder the user chose. Maximum likelihood decoding breaks ties differently
+// than syndrome decoding, so one is never switched to the other.
+static void autotuneDecoder(CommonParams& params, std::string_view cachePath) {
+    if (params.syndromeOracle || (!params.syndromes && !params.mlDecoder)) return;
+    std::string_view what = params.mlDecoder ? "ml" : "batch";
+    uint64_t key = tuningKey(params, what);
+    if (std::optional<std::string> cached = readCachedChoice(cachePath, key, what)) {
+        // cache file can be copied from another machine, level must still be supported
+        std::optional<SimdLevel> level = simdLevelFromName(*cached);
+        if (level && *level <= detectSimdLevel()) {
+            params.decodeLevel = *level;
+            std::print("Dekodavimo budas paimtas is '{}': {} {}\n", cachePath, what, *cached);
+            return;
+        }
+    }
+
+    std::vector<vec> received = randomWorkload(params, key), output(workloadSize);
+    std::span<const vec> verified = std::span<const vec>(received).first(verifyCount);
+
+    // reference is decode for syndrome decoding, scalar version for maximum likelihood decoding
+    std::vector<vec> reference(verifyCount);
+    std::function<void(std::span<const vec>, std::span<vec>, SimdLevel)> decodeFn;
+    if (params.mlDecoder) {
+        params.mlDecoder->decode(verified, reference, SimdLevel::scalar);
+        decodeFn = [&](std::span<const vec> in, std::span<vec> out, SimdLevel level) { params.mlDecoder->decode(in, out, level); };
+    } else {
+        const SyndromeData& syndromeData = waitForSyndromes(*params.syndromes);
+        for (size_t i = 0; i < verifyCount; i++) reference[i] = decode(verified[i], syndromeData.syndromes, params.h);
+        decodeFn = [&](std::span<const vec> in, std::span<vec> out, SimdLevel level) {
+            decodeBatch(in, out, syndromeData.table, syndromeData.tableH, level);
+        };
+    }
+
+    std::print("Derinamas dekodavimas (n={}, k={}):\n", params.n, params.k);
+    std::optional<SimdLevel> best;
+    double bestThroughput = 0;
+    for (SimdLevel level : { SimdLevel::scalar, SimdLevel::avx2, SimdLevel::avx512 }) {
+        if (level > detectSimdLevel()) continue;
+        double throughput = measureThroughput(received, output, [&](std::span<const vec> in, std::span<vec> out) {
+            decodeFn(in, out, level);
+        });
+        bool identical = std::equal(reference.begin(), reference.end(), output.begin());
+        std::print("  {:>14}: {:10.3f} Mvec/s{}\n", std::format("{} {}", what, simdLevelName(level)), throughput / 1e6,
+                   identical ? "" : " (rezultatai nesutampa, praleidziama)");
+        if (identical && throughput > bestThroughput) {
+            best = level;
+            bestThroughput = throughput;
+        }
+    }
+
+    if (!best) {
+        std::print("Klaida! Nei vienas dekodavimo budas nedave teisingu rezultatu, paliekamas numatytasis.\n");
+        return;
+    }
+    params.decodeLevel = *best;
+    writeCachedChoice(cachePath, key, what, simdLevelName(*best));
+    std::print("Pasirinkta: {} {}\n", what, simdLevelName(*best));
+}
+
+void autotune(CommonParams& params, std::string_view cachePath) {
+    autotuneEncoder(params, cachePath);
+    autotuneDecoder(params, cachePath);
+}
+
+void autotuneLazily(CommonParams& params, size_t fullDecodeTableBudget, std::string_view cachePath) {
+    autotuneEncoder(params, cachePath);
+    params.lazyAutotune.reset();
+    if (params.syndromeOracle || (!params.syndromes && !params.mlDecoder)) return;
+    auto lazy = std::make_shared<LazyAutotune>();
+    lazy->tuned = params;
+    lazy->cachePath = cachePath;
+    if (params.syndromes && !params.mlDecoder && params.n <= fullDecodeTableMaxN
+        && fullDecodeTableBytes(params.n, params.k) <= fullDecodeTableBudget) {
+        lazy->builder = std::jthread([lazy = lazy.get(), params, fullDecodeTableBudget](std::stop_token stop) mutable {
+            // waits quietly, progress of syndromes is shown only when a decode waits for them
+            while (!params.syndromes->ready()) {
+                if (stop.stop_requested()) return;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            try {
+                if (!useFullDecodeTable(params, fullDecodeTableBudget)) return;
+            } catch (const std::exception&) {
+                return; // syndromes were cancelled or failed, decode reports it
+            }
+            lazy->table = params.fullDecodeTable;
+            lazy->tableBuilt.store(true, std::memory_order_release);
+        });
+    }
+    params.lazyAutotune = std::move(lazy);
+}
+
+const CommonParams& tunedParams(const CommonParams& params) {
+    if (!params.lazyAutotune) return params;
+    LazyAutotune& lazy = *params.lazyAutotune;
+    std::call_once(lazy.once, [&] { autotuneDecoder(lazy.tuned, lazy.cachePath); });
+    if (lazy.tableBuilt.load(std::memory_order_acquire)) {
+        std::call_once(lazy.tableOnce, [&] {
+            lazy.withTable = lazy.tuned;
+            lazy.withTable.fullDecodeTable = lazy.table;
+            std::print("Dekoduojama pilna dekodavimo lentele ({:.2f} MiB, visi 2^{} gauti vektoriai).\n",
+                       fullDecodeTableBytes(lazy.tuned.n, lazy.tuned.k) / double(1 << 20), lazy.tuned.n);
+            lazy.tableUsed.store(true, std::memory_order_release);
+        });
+    }
+    return lazy.tableUsed.load(std::memory_order_acquire) ? lazy.withTable : lazy.tuned;
+}
+
+bool useFullDecodeTable(CommonParams& params, size_t memoryBudget, std::string_view cacheDirectory) {
+    params.fullDecodeTable.reset();
+    if (!params.syndromes || params.mlDecoder || params.syndromeOracle) return false;
+    if (params.n > fullDecodeTableMaxN || fullDecodeTableBytes(params.n, params.k) > memoryBudget) return false;
+
+    // table depends only on code, not on instruction set
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hashValue(hash, params.n);
+    hashValue(hash, params.k);
+    for (size_t r = 0; r < params.k; r++) hashValue(hash, params.g.data()[r]);
+    std::string path;
+    std::shared_ptr<const FullDecodeTable> table;
+    if (!cacheDirectory.empty()) {
+        path = (std::filesystem::path(cacheDirectory) / std::format("fulltable_{:016x}.bin", hash)).string();
+        table = FullDecodeTable::load(path, params.n, params.k, hash);
+    }
+
+    const SyndromeData& syndromeData = waitForSyndromes(*params.syndromes); // progress is shown before threads start
+    if (!table) {
+        table = std::make_shared<const FullDecodeTable>(params.n, params.k, [&](std::span<vec> words) {
+            decodeBatch<vec>(words, words, syndromeData.table, syndromeData.tableH, params.decodeLevel);
+        });
+        if (!path.empty()) table->save(path, hash);
+    }
+
+    // table is used only if lookups are faster than batch decoding, which they stop being once the table
+    // misses cache on most lookups. Not cached in autotune.txt, so pipe-filter mode doesn't write files it wasn't asked to.
+    std::vector<vec> received = randomWorkload(params, hash), output(workloadSize);
+    double tableThroughput = measureThroughput(received, output, [&](std::span<const vec> in, std::span<vec> out) {
+        table->decode<vec>(in, out);
+    });
+    double batchThroughput = measureThroughput(received, output, [&](std::span<const vec> in, std::span<vec> out) {
+        decodeBatch<vec>(in, out, syndromeData.table, syndromeData.tableH, params.decodeLevel);
+    });
+    if (tableThroughput <= batchThroughput) return false;
+    params.fullDecodeTable = std::move(table);
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <string_view>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+
+#include "io.h"
+
+// File where autotuning decisions are cached, relative to working directory.
+constexpr std::string_view defaultAutotuneCachePath = "autotune.txt";
+
+// Full decode table is used only if it takes at most this many bytes. Bigger tables miss cache on almost every lookup
+// and are no faster than batch decoding (break-even was about 16 MiB, n = 24, k = 8).
+constexpr size_t defaultFullDecodeTableBudget = size_t{16} << 20;
+
+// Decoder autotuning postponed until the first decode, so the program doesn't wait for syndromes
+// before it needs them (encoding and sending unencoded data can start right away).
+// Full decode table is built in background once syndromes are generated, so no decode waits for it;
+// decoding switches to the table when it is ready (results are the same with and without it).
+// Shared by copies of CommonParams, so a code is tuned only once.
+struct LazyAutotune {
+    std::once_flag once;
+    std::string cachePath; // file of cached decisions
+    CommonParams tuned; // copy of params with tuned decoder, set on first decode
+
+    std::shared_ptr<const FullDecodeTable> table; // set by builder before tableBuilt
+    std::atomic<bool> tableBuilt = false;
+    std::once_flag tableOnce;
+    CommonParams withTable; // tuned params with full decode table, set before tableUsed
+    std::atomic<bool> tableUsed = false;
+    std::jthread builder; // declared last, so it is stopped and joined before other members are destroyed
+};
+
+// Picks fastest encoder and decoder of a code and sets them in params.
+// Every available implementation of the decoder the user chose (batch decoding or maximum likelihood decoding,
+// with every instruction set) and, for cyclic codes, polynomial and matrix encoding are timed on a short random workload.
+// Implementations whose results differ from the reference ones are skipped. Decisions are cached by code size,
+// decoder and CPU, so codes of the same size are tuned only once. Codes with syndromes computed on demand are left as they are.
+// If syndromes are still being generated, waits for them and shows progress.
+// args:
+//   params - common parameters. Instruction set and encoder get changed.
+//   cachePath - file of cached decisions.
+void autotune(CommonParams& params, std::string_view cachePath = defaultAutotuneCachePath);
+
+// Tunes encoder right away, postpones decoder tuning until the first decode and starts building full decode table
+// in background (see LazyAutotune).
+// args:
+//   params - common parameters. Encoder gets changed, lazyAutotune gets set.
+//   fullDecodeTableBudget - largest allowed full decode table size in bytes, 0 disables full decode table.
+//   cachePath - file of cached decisions.
+void autotuneLazily(CommonParams& params, size_t fullDecodeTableBudget = defaultFullDecodeTableBudget,
+                    std::string_view cachePath = defaultAutotuneCachePath);
+
+// Returns params to decode with. If decoder is tuned lazily, tunes it on the first call (thread safe),
+// and switches to full decode table once it is built.
+// args:
+//   params - common parameters.
+// returns:
+//   const CommonParams& - params itself, or its tuned copy.
+const CommonParams& tunedParams(const CommonParams& params);
+
+// Switches decoding to full decode table (see FullDecodeTable) if the table fits into memory budget
+// and its lookups are faster than batch decoding on a short random workload (big tables miss cache on most lookups).
+// Table is built with batch decoding of syndromes (instruction set from params), so results are identical to decode.
+// If cache directory is given, built table is saved there and is mapped from there next time instead of being built again.
+// Only codes decoded with generated syndromes get a table: maximum likelihood decoding breaks ties differently.
+// If syndromes are still being generated, waits for them and shows progress.
+// args:
+//   params - common parameters. Full decode table gets set.
+//   memoryBudget - largest allowed table size in bytes, 0 disables full decode table.
+//   cacheDirectory - directory of cached tables, empty to disable caching.
+// returns:
+//   bool - true if full decode table is used.
+bool useFullDecodeTable(CommonParams& params, size_t memoryBudget = defaultFullDecodeTableBudget,
+                        std::string_view cacheDirectory = {});
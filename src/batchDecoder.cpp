@@ -0,0 +1,417 @@
+#include "batchDecoder.h"
+
+#include <assert.h>
+#include <cstring>
+#include <array>
+#include <bit>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define BATCH_DECODER_X86
+#endif
+
+// gathers read 8 bytes starting at syndrome index, so table needs 7 extra bytes
+constexpr size_t tablePadding = 7;
+
+SyndromeTable makeSyndromeTable(const Syndromes& syndromes, size_t syndromeBits) {
+    SyndromeTable table((1ULL << syndromeBits) + tablePadding, 0);
+    for (const auto& [syndrome, weight] : syndromes) {
+        table[syndrome] = weight;
+    }
+    return table;
+}
+
+// Invertible matrix T that reorders syndrome table (see localizeSyndromeTable).
+struct LocalityTransform {
+    matrix h; // T * H
+    std::array<vec, 64> basis; // basis[i] = T^-1 * 2^i
+    std::array<std::array<vec, 256>, 8> byteImages; // byteImages[b][x] = T * (x << 8b), so T * s takes a lookup per byte of s
+
+    // Returns T * syndrome.
+    vec apply(vec syndrome) const {
+        vec result = 0;
+        for (size_t b = 0; syndrome != 0; b++, syndrome >>= 8) result ^= byteImages[b][syndrome & 0xFF];
+        return result;
+    }
+};
+
+// Chooses T for control matrix.
+// args:
+//   h - control matrix.
+// returns:
+//   LocalityTransform - T and T * H.
+static LocalityTransform makeLocalityTransform(const matrix& h) {
+    size_t n = h.cols();
+    size_t m = h.rows();
+    matrix hTransposed = h.transpose();
+    const vec* columns = hTransposed.data().data();
+
+    // basis of syndrome space, kept in echelon form for solving: reduced[bit] has highest bit 'bit'
+    // and is the sum of basis vectors marked in combination[bit]
+    LocalityTransform t{ matrix(m, n), {}, {} };
+    std::array<vec, 64> reduced{}, combination{};
+    size_t basisSize = 0;
+    // returns coordinates of syndrome in basis, that is T * syndrome
+    auto coordinates = [&](vec syndrome, vec& remainder) {
+        vec result = 0;
+        for (size_t bit = m; bit-- > 0;) {
+            if (((syndrome >> bit) & 1) && reduced[bit] != 0) {
+                syndrome ^= reduced[bit];
+                result ^= combination[bit];
+            }
+        }
+        remainder = syndrome;
+        return result;
+    };
+    // columns in the order decoding flips them, identity part of H completes the basis
+    for (size_t j = 0; j < n && basisSize < m; j++) {
+        vec remainder;
+        vec result = coordinates(columns[j], remainder);
+        if (remainder == 0) continue;
+        size_t pivot = std::bit_width(remainder) - 1;
+        reduced[pivot] = remainder;
+        combination[pivot] = result ^ (vec{1} << basisSize);
+        t.basis[basisSize++] = columns[j];
+    }
+    assert(basisSize == m);
+
+    for (size_t j = 0; j < n; j++) {
+        vec remainder;
+        vec column = coordinates(columns[j], remainder);
+        for (size_t row = 0; row < m; row++) t.h.setVal(row, j, (column >> (m - 1 - row)) & 1);
+    }
+    for (size_t b = 0; b < t.byteImages.size(); b++) {
+        for (size_t x = 0; x < 256; x++) {
+            vec remainder;
+            t.byteImages[b][x] = b * 8 < m ? coordinates(vec{x} << (b * 8), remainder) : 0;
+        }
+    }
+    return t;
+}
+
+LocalSyndromeTable localizeSyndromeTable(const SyndromeTable& table, const matrix& h) {
+    size_t m = h.rows();
+    LocalityTransform t = makeLocalityTransform(h);
+    LocalSyndromeTable local{ t.h, SyndromeTable(table.size(), 0) };
+    // entry x of new table is entry T^-1 * x (sum of basis vectors marked in x) of old one,
+    // x goes in Gray code order, so one basis vector is added per entry
+    vec syndrome = 0;
+    local.table[0] = table[0];
+    for (size_t i = 1; i < (size_t{1} << m); i++) {
+        syndrome ^= t.basis[std::countr_zero(i)];
+        local.table[i ^ (i >> 1)] = table[syndrome];
+    }
+    return local;
+}
+
+matrix localSyndromeControlMatrix(const matrix& h) {
+    return makeLocalityTransform(h).h;
+}
+
+LocalSyndromeTable makeLocalSyndromeTable(const Syndromes& syndromes, const matrix& h) {
+    LocalityTransform t = makeLocalityTransform(h);
+    LocalSyndromeTable local{ t.h, SyndromeTable((1ULL << h.rows()) + tablePadding, 0) };
+    for (const auto& [syndrome, weight] : syndromes) {
+        local.table[t.apply(syndrome)] = weight;
+    }
+    return local;
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef BATCH_DECODER_X86
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::avx512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::avx2;
+#endif
+    return SimdLevel::scalar;
+}
+
+std::string_view simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::avx2: return "avx2";
+    case SimdLevel::avx512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+// Computes syndrome of r as a sum of columns of H for every set bit of r.
+// args:
+//   r - vector to compute syndrome of.
+//   columns - columns of control matrix.
+//   n - number of bits in r.
+// returns:
+//   vec - syndrome of r (H * r).
+static vec syndromeFromColumns(vec r, const vec* columns, size_t n) {
+    vec s = 0;
+    for (size_t j = 0; j < n; j++) {
+        s ^= columns[j] & (vec{0} - ((r >> (n - j - 1)) & 1));
+    }
+    return s;
+}
+
+// Same algorithm as decode, but with incrementally updated syndrome and dense table.
+// args:
+//   r - vector to decode.
+//   s - syndrome of r.
+static vec decodeScalar(vec r, vec s, const uint8_t* table, const vec* columns, size_t n, size_t k) {
+    for (size_t i = 0; i < k; i++) {
+        // next step looks up s or s ^ column i, both already loaded, and the same flipped by next column,
+        // so start loading both candidates of that now
+        if (i + 1 < k) {
+            __builtin_prefetch(table + (s ^ columns[i + 1]));
+            __builtin_prefetch(table + (s ^ columns[i] ^ columns[i + 1]));
+        }
+        uint8_t rWeight = table[s];
+        if (rWeight == 0) break;
+
+        vec flippedS = s ^ columns[i];
+        if (table[flippedS] < rWeight) {
+            r ^= 1ULL << (n - i - 1);
+            s = flippedS;
+        }
+    }
+    return r >> (n - k);
+}
+
+#ifdef BATCH_DECODER_X86
+
+// Loads and stores of SIMD lanes from arrays of narrower words. Words are zero extended when loaded
+// and truncated when stored, so the kernels always work on full lanes.
+
+template <VectorWord T>
+__attribute__((target("avx2")))
+static inline __m256i loadLanes4(const T* p) {
+    if constexpr (sizeof(T) == 8) return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    else if constexpr (sizeof(T) == 4) return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    else if constexpr (sizeof(T) == 2) return _mm256_cvtepu16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    else {
+        uint32_t bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        return _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes));
+    }
+}
+
+template <VectorWord T>
+__attribute__((target("avx2")))
+static inline void storeLanes4(T* p, __m256i v) {
+    if constexpr (sizeof(T) == 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    } else {
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+        for (size_t i = 0; i < 4; i++) p[i] = static_cast<T>(lanes[i]);
+    }
+}
+
+template <VectorWord T>
+__attribute__((target("avx512f")))
+static inline __m512i loadLanes8(const T* p) {
+    if constexpr (sizeof(T) == 8) return _mm512_loadu_si512(p);
+    else if constexpr (sizeof(T) == 4) return _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    else if constexpr (sizeof(T) == 2) return _mm512_cvtepu16_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    else return _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+
+template <VectorWord T>
+__attribute__((target("avx512f")))
+static inline void storeLanes8(T* p, __m512i v) {
+    if constexpr (sizeof(T) == 8) _mm512_storeu_si512(p, v);
+    else if constexpr (sizeof(T) == 4) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi64_epi32(v));
+    else if constexpr (sizeof(T) == 2) _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtepi64_epi16(v));
+    else _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm512_cvtepi64_epi8(v));
+}
+
+// 16 words narrowed (or widened) to 32-bit lanes.
+template <VectorWord T>
+__attribute__((target("avx512f")))
+static inline __m512i loadLanes16(const T* p) {
+    if constexpr (sizeof(T) == 8) {
+        __m256i low = _mm512_cvtepi64_epi32(_mm512_loadu_si512(p));
+        __m256i high = _mm512_cvtepi64_epi32(_mm512_loadu_si512(p + 8));
+        return _mm512_inserti64x4(_mm512_castsi256_si512(low), high, 1);
+    }
+    else if constexpr (sizeof(T) == 4) return _mm512_loadu_si512(p);
+    else if constexpr (sizeof(T) == 2) return _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    else return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+template <VectorWord T>
+__attribute__((target("avx512f")))
+static inline void storeLanes16(T* p, __m512i v) {
+    if constexpr (sizeof(T) == 8) {
+        _mm512_storeu_si512(p, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(v)));
+        _mm512_storeu_si512(p + 8, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    else if constexpr (sizeof(T) == 4) _mm512_storeu_si512(p, v);
+    else if constexpr (sizeof(T) == 2) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi32_epi16(v));
+    else _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtepi32_epi8(v));
+}
+
+template <VectorWord T>
+__attribute__((target("avx2")))
+static void decodeAvx2(const T* input, T* output, size_t count, const uint8_t* table, const vec* columns, size_t n, size_t k) {
+    const long long* base = reinterpret_cast<const long long*>(table);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i byteMask = _mm256_set1_epi64x(0xFF);
+
+    for (size_t i = 0; i < count; i += 4) {
+        __m256i r = loadLanes4(input + i);
+
+        // syndromes of all 4 lanes
+        __m256i s = zero;
+        for (size_t j = 0; j < n; j++) {
+            __m256i bit = _mm256_and_si256(_mm256_srl_epi64(r, _mm_cvtsi64_si128(n - j - 1)), one);
+            __m256i column = _mm256_set1_epi64x(columns[j]);
+            s = _mm256_xor_si256(s, _mm256_and_si256(_mm256_sub_epi64(zero, bit), column));
+        }
+
+        __m256i active = _mm256_cmpeq_epi64(zero, zero);
+        for (size_t step = 0; step < k; step++) {
+            __m256i rWeight = _mm256_and_si256(_mm256_i64gather_epi64(base, s, 1), byteMask);
+            // lanes with weight 0 are done
+            active = _mm256_andnot_si256(_mm256_cmpeq_epi64(rWeight, zero), active);
+            if (_mm256_testz_si256(active, active)) break;
+
+            __m256i flippedS = _mm256_xor_si256(s, _mm256_set1_epi64x(columns[step]));
+            __m256i flippedWeight = _mm256_and_si256(_mm256_i64gather_epi64(base, flippedS, 1), byteMask);
+            __m256i flip = _mm256_and_si256(_mm256_cmpgt_epi64(rWeight, flippedWeight), active);
+
+            __m256i flippedR = _mm256_xor_si256(r, _mm256_set1_epi64x(1ULL << (n - step - 1)));
+            r = _mm256_blendv_epi8(r, flippedR, flip);
+            s = _mm256_blendv_epi8(s, flippedS, flip);
+        }
+
+        r = _mm256_srl_epi64(r, _mm_cvtsi64_si128(n - k));
+        storeLanes4(output + i, r);
+    }
+}
+
+template <VectorWord T>
+__attribute__((target("avx512f")))
+static void decodeAvx512(const T* input, T* output, size_t count, const uint8_t* table, const vec* columns, size_t n, size_t k) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i byteMask = _mm512_set1_epi64(0xFF);
+
+    for (size_t i = 0; i < count; i += 8) {
+        __m512i r = loadLanes8(input + i);
+
+        // syndromes of all 8 lanes
+        __m512i s = zero;
+        for (size_t j = 0; j < n; j++) {
+            __mmask8 bit = _mm512_test_epi64_mask(r, _mm512_set1_epi64(1ULL << (n - j - 1)));
+            s = _mm512_mask_xor_epi64(s, bit, s, _mm512_set1_epi64(columns[j]));
+        }
+
+        __mmask8 active = 0xFF;
+        for (size_t step = 0; step < k; step++) {
+            __m512i rWeight = _mm512_and_si512(_mm512_i64gather_epi64(s, table, 1), byteMask);
+            // lanes with weight 0 are done
+            active = _mm512_mask_cmpneq_epi64_mask(active, rWeight, zero);
+            if (active == 0) break;
+
+            __m512i flippedS = _mm512_xor_si512(s, _mm512_set1_epi64(columns[step]));
+            __m512i flippedWeight = _mm512_and_si512(_mm512_i64gather_epi64(flippedS, table, 1), byteMask);
+            __mmask8 flip = _mm512_mask_cmpgt_epi64_mask(active, rWeight, flippedWeight);
+
+            r = _mm512_mask_xor_epi64(r, flip, r, _mm512_set1_epi64(1ULL << (n - step - 1)));
+            s = _mm512_mask_blend_epi64(flip, s, flippedS);
+        }
+
+        r = _mm512_srl_epi64(r, _mm_cvtsi64_si128(n - k));
+        storeLanes8(output + i, r);
+    }
+}
+
+// Variant for n <= 32: vectors are narrowed to 32 bits, so 16 of them fit into one register.
+template <VectorWord T>
+__attribute__((target("avx512f")))
+static void decodeAvx512Narrow(const T* input, T* output, size_t count, const uint8_t* table, const vec* columns, size_t n, size_t k) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i byteMask = _mm512_set1_epi32(0xFF);
+
+    for (size_t i = 0; i < count; i += 16) {
+        __m512i r = loadLanes16(input + i);
+
+        // syndromes of all 16 lanes
+        __m512i s = zero;
+        for (size_t j = 0; j < n; j++) {
+            __mmask16 bit = _mm512_test_epi32_mask(r, _mm512_set1_epi32(static_cast<uint32_t>(1ULL << (n - j - 1))));
+            s = _mm512_mask_xor_epi32(s, bit, s, _mm512_set1_epi32(static_cast<uint32_t>(columns[j])));
+        }
+
+        __mmask16 active = 0xFFFF;
+        for (size_t step = 0; step < k; step++) {
+            __m512i rWeight = _mm512_and_si512(_mm512_i32gather_epi32(s, table, 1), byteMask);
+            // lanes with weight 0 are done
+            active = _mm512_mask_cmpneq_epi32_mask(active, rWeight, zero);
+            if (active == 0) break;
+
+            __m512i flippedS = _mm512_xor_si512(s, _mm512_set1_epi32(static_cast<uint32_t>(columns[step])));
+            __m512i flippedWeight = _mm512_and_si512(_mm512_i32gather_epi32(flippedS, table, 1), byteMask);
+            __mmask16 flip = _mm512_mask_cmpgt_epi32_mask(active, rWeight, flippedWeight);
+
+            r = _mm512_mask_xor_epi32(r, flip, r, _mm512_set1_epi32(static_cast<uint32_t>(1ULL << (n - step - 1))));
+            s = _mm512_mask_blend_epi32(flip, s, flippedS);
+        }
+
+        r = _mm512_srl_epi32(r, _mm_cvtsi64_si128(n - k));
+        storeLanes16(output + i, r);
+    }
+}
+
+#endif
+
+template <VectorWord T>
+void decodeBatch(std::type_identity_t<std::span<const T>> input, std::type_identity_t<std::span<T>> output,
+                 const SyndromeTable& table, const matrix& h, SimdLevel level) {
+    assert(input.size() == output.size());
+    size_t n = h.cols();
+    size_t k = n - h.rows();
+    assert(n <= sizeof(T) * 8);
+    assert(table.size() == (1ULL << h.rows()) + tablePadding);
+
+    // column j of h is the syndrome of error vector with only bit j set
+    matrix hTransposed = h.transpose();
+    const vec* columns = hTransposed.data().data();
+
+    if (level > detectSimdLevel()) level = detectSimdLevel();
+    size_t done = 0;
+#ifdef BATCH_DECODER_X86
+    if (level == SimdLevel::avx512 && n <= 32) {
+        done = input.size() - input.size() % 16;
+        decodeAvx512Narrow(input.data(), output.data(), done, table.data(), columns, n, k);
+    } else if (level == SimdLevel::avx512) {
+        done = input.size() - input.size() % 8;
+        decodeAvx512(input.data(), output.data(), done, table.data(), columns, n, k);
+    } else if (level == SimdLevel::avx2) {
+        done = input.size() - input.size() % 4;
+        decodeAvx2(input.data(), output.data(), done, table.data(), columns, n, k);
+    }
+#endif
+
+    // remaining vectors that don't fill all lanes. First lookup of the next vector is started
+    // while the current one is decoded.
+    vec s = done < input.size() ? syndromeFromColumns(input[done], columns, n) : 0;
+    for (size_t i = done; i < input.size(); i++) {
+        vec nextS = 0;
+        if (i + 1 < input.size()) {
+            nextS = syndromeFromColumns(input[i + 1], columns, n);
+            __builtin_prefetch(table.data() + nextS);
+        }
+        output[i] = static_cast<T>(decodeScalar(input[i], s, table.data(), columns, n, k));
+        s = nextS;
+    }
+}
+
+vec decodeWithTable(vec input, const SyndromeTable& table, const matrix& hTransposed) {
+    size_t n = hTransposed.rows();
+    size_t k = n - hTransposed.cols();
+    assert(table.size() == (1ULL << hTransposed.cols()) + tablePadding);
+    const vec* columns = hTransposed.data().data();
+    return decodeScalar(input, syndromeFromColumns(input, columns, n), table.data(), columns, n, k);
+}
+
+template void decodeBatch<uint8_t>(std::span<const uint8_t>, std::span<uint8_t>, const SyndromeTable&, const matrix&, SimdLevel);
+template void decodeBatch<uint16_t>(std::span<const uint16_t>, std::span<uint16_t>, const SyndromeTable&, const matrix&, SimdLevel);
+template void decodeBatch<uint32_t>(std::span<const uint32_t>, std::span<uint32_t>, const SyndromeTable&, const matrix&, SimdLevel);
+template void decodeBatch<uint64_t>(std::span<const uint64_t>, std::span<uint64_t>, const SyndromeTable&, const matrix&, SimdLevel);
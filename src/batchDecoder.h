@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <string_view>
+
+#include "math.h"
+#include "encoder.h"
+
+// Dense syndrome table: weight of every syndrome, indexed by the syndrome itself.
+// Has 2^(n-k) entries, plus a few padding bytes at the end, so SIMD gathers can read whole words.
+using SyndromeTable = std::vector<uint8_t>;
+
+// Largest n-k for which dense syndrome table is built (2^32 entries, 4 GiB).
+constexpr size_t maxSyndromeBits = 32;
+
+// Syndrome table reordered for cache locality, together with control matrix whose syndromes index it.
+struct LocalSyndromeTable {
+    matrix h; // T * H
+    SyndromeTable table; // weight of syndrome s is at T * s
+};
+
+// Reorders syndrome table, so lookups made while decoding one vector are close to each other in memory.
+// Syndromes are multiplied by invertible matrix T, chosen so that columns of H flipped in the first decoding steps
+// become single low bits (T * column i = 2^i, as long as columns are linearly independent).
+// Both lookups of a step (s and s ^ column i) and lookups of following steps then differ only in low bits,
+// so the first 6 steps stay in one 64-byte cache line and the first 12 in one 4 KiB page.
+// Weight of every syndrome stays the same, so decoding with T * H and reordered table gives the same results.
+// args:
+//   table - dense syndrome table.
+//   h - control matrix.
+// returns:
+//   LocalSyndromeTable - reordered table and control matrix to decode with.
+LocalSyndromeTable localizeSyndromeTable(const SyndromeTable& table, const matrix& h);
+
+// Returns control matrix T * H that reordered syndrome tables of a code are indexed by (see localizeSyndromeTable).
+// Depends only on H, so it can be computed again for a table loaded from file.
+// args:
+//   h - control matrix.
+// returns:
+//   matrix - control matrix to decode with.
+matrix localSyndromeControlMatrix(const matrix& h);
+
+// Builds reordered syndrome table (see localizeSyndromeTable) straight from syndrome map,
+// without a dense table in original order, so only one 2^(n-k) table is in memory.
+// Syndromes missing from the map get weight 0, same as in decode.
+// args:
+//   syndromes - map of syndromes and their weights.
+//   h - control matrix.
+// returns:
+//   LocalSyndromeTable - reordered table and control matrix to decode with.
+LocalSyndromeTable makeLocalSyndromeTable(const Syndromes& syndromes, const matrix& h);
+
+// Instruction sets that batch decoding can use.
+enum class SimdLevel {
+    scalar,
+    avx2,
+    avx512,
+};
+
+// Converts syndrome map to dense syndrome table.
+// Syndromes missing from the map get weight 0, same as in decode.
+// args:
+//   syndromes - map of syndromes and their weights.
+//   syndromeBits - number of bits in syndrome (n-k).
+// returns:
+//   SyndromeTable - dense syndrome table.
+SyndromeTable makeSyndromeTable(const Syndromes& syndromes, size_t syndromeBits);
+
+// Finds best instruction set supported by this CPU.
+// returns:
+//   SimdLevel - best supported instruction set.
+SimdLevel detectSimdLevel();
+
+// Returns name of instruction set.
+// args:
+//   level - instruction set.
+// returns:
+//   std::string_view - name of instruction set, e.g. "avx2".
+std::string_view simdLevelName(SimdLevel level);
+
+// Decodes a batch of vectors, running several vectors in lockstep in SIMD lanes
+// (4 with AVX2, 8 with AVX-512, 16 with AVX-512 if n <= 32).
+// Results are identical to calling decode on every vector.
+// Vectors can be stored in narrower words than vec (see VectorWord), which is cheaper for memory bandwidth.
+// Syndromes are updated incrementally (H * (r + e_i) = H * r + column i), so H is multiplied only once per vector.
+// template args:
+//   T - word vectors are stored in, must have at least n bits. vec if not given.
+// args:
+//   input - vectors to decode.
+//   output - decoded vectors. Must be the same size as input, can be the same span.
+//   table - dense syndrome table (can be reordered by localizeSyndromeTable).
+//   h - control matrix whose syndromes index table.
+//   level - instruction set to use. If CPU does not support it, scalar code is used.
+template <VectorWord T = vec>
+void decodeBatch(std::type_identity_t<std::span<const T>> input, std::type_identity_t<std::span<T>> output,
+                 const SyndromeTable& table, const matrix& h, SimdLevel level = detectSimdLevel());
+
+// Decodes one vector with dense syndrome table, same as scalar part of decodeBatch (incremental syndrome,
+// lookups of the next step are prefetched). Results are identical to decode.
+// Takes transposed control matrix, so decoding single vectors doesn't transpose H every time.
+// args:
+//   input - vector to decode.
+//   table - dense syndrome table (can be reordered by localizeSyndromeTable).
+//   hTransposed - transposed control matrix whose syndromes index table (rows are columns of H).
+// returns:
+//   vec - decoded message.
+vec decodeWithTable(vec input, const SyndromeTable& table, const matrix& hTransposed);
@@ -0,0 +1,1126 @@
+#include "benchmark.h"
+
+#include <print>
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+#include <map>
+#include <string>
+#include <cstdio>
+#include <charconv>
+#include <bit>
+#include <random>
+#include <optional>
+#include <cmath>
+#include <numeric>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <format>
+#include <atomic>
+#include <new>
+#include <set>
+#include <span>
+#include <thread>
+
+#include "encoder.h"
+#include "io.h"
+#include "cyclic.h"
+#include "mlDecoder.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+batch runSingleNK(const std::vector<double>& errorRates, size_t n, size_t k, Channel c, bool readCounters) {
+    batch result{};
+    size_t inputMatRows = k;
+    size_t inputMatCols = n - k;
+    matrix g = matrix(k, k, true).append(randomMatrix(inputMatRows, inputMatCols));
+    matrix gTransposed = g.transpose();
+    matrix h = calculateControlMatrix(g);
+
+    std::optional<PerfCounters> counters;
+    if (readCounters) counters.emplace();
+
+    std::print("N: {}, K: {}\n", n, k);
+    std::print("  Generating syndromes... ");
+    if (counters) counters->start();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    Syndromes syndromes = calculateSyndromes(h);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    if (counters) result.syndromeGenCounters = counters->stop();
+    result.syndromeGenTimeMs = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::print("Syndromes generated ({}ms)\n", result.syndromeGenTimeMs);
+    if (counters) printPerfCounters("syndrome generation", result.syndromeGenCounters, syndromes.size());
+
+    size_t vecCount = 125'000;
+    size_t totalVecCount = vecCount * errorRates.size();
+    result.totalVecCount = totalVecCount;
+    std::vector<vec> originals(vecCount), received(vecCount);
+    if (counters) result.decodeCounters.values.fill(0); // summed over error rates, add leaves unavailable counters empty
+    begin = std::chrono::steady_clock::now();
+    for (double p : errorRates) {
+        for (size_t i = 0; i < vecCount; i++) {
+            originals[i] = std::rand() % (1ULL << k);
+            vec r = encode(originals[i], gTransposed);
+            received[i] = c.sendVector(r, n, p);
+        }
+
+        // decoding is measured separately, so counters show only decode
+        if (counters) counters->start();
+        size_t errors = 0;
+        for (size_t i = 0; i < vecCount; i++) {
+            vec out = decode(received[i], syndromes, h);
+            if (originals[i] != out) errors++;
+        }
+        if (counters) result.decodeCounters.add(counters->stop());
+
+        double errRate = static_cast<double>(errors) / vecCount;
+        result.successfulDecodeRates.push_back((1.0 - errRate) * 100.0);
+    }
+    end = std::chrono::steady_clock::now();
+    result.testRunTimeMs = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::print("  Tests ran ({}ms)\n", result.testRunTimeMs);
+    if (counters) {
+        if (!counters->available()) std::print("  Hardware counters are not available\n");
+        printPerfCounters("decode", result.decodeCounters, totalVecCount);
+    }
+    return result;
+}
+
+batch runSingleNKCoupled(const std::vector<double>& errorRates, size_t n, size_t k, Channel c) {
+    batch result{};
+    matrix g = matrix(k, k, true).append(randomMatrix(k, n - k));
+    matrix gTransposed = g.transpose();
+    matrix h = calculateControlMatrix(g);
+
+    std::print("N: {}, K: {} (coupled)\n", n, k);
+    std::print("  Generating syndromes... ");
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    Syndromes syndromes = calculateSyndromes(h);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    result.syndromeGenTimeMs = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::print("Syndromes generated ({}ms)\n", result.syndromeGenTimeMs);
+
+    // sorted error rates, and where each of them is in errorRates
+    std::vector<size_t> order(errorRates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return errorRates[a] < errorRates[b]; });
+    std::vector<double> sortedRates(errorRates.size());
+    for (size_t j = 0; j < order.size(); j++) sortedRates[j] = errorRates[order[j]];
+
+    size_t vecCount = 125'000;
+    result.totalVecCount = vecCount * errorRates.size();
+    std::vector<size_t> errors(errorRates.size(), 0);
+    std::vector<vec> errorVectors(errorRates.size());
+    size_t decodes = 0;
+    begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < vecCount; i++) {
+        vec original = std::rand() % (1ULL << k);
+        vec encoded = encode(original, gTransposed);
+        c.errorVectors(n, sortedRates, errorVectors);
+
+        vec previousError = 0;
+        vec out = original; // no errors decode to original
+        for (size_t j = 0; j < sortedRates.size(); j++) {
+            if (errorVectors[j] != previousError) {
+                out = decode(encoded ^ errorVectors[j], syndromes, h);
+                previousError = errorVectors[j];
+                decodes++;
+            }
+            if (original != out) errors[order[j]]++;
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    result.testRunTimeMs = std::chrono::duration<double, std::milli>(end - begin).count();
+
+    for (size_t e : errors) {
+        double errRate = static_cast<double>(e) / vecCount;
+        result.successfulDecodeRates.push_back((1.0 - errRate) * 100.0);
+    }
+    std::print("  Tests ran ({}ms, {} of {} decodes needed)\n", result.testRunTimeMs, decodes, result.totalVecCount);
+    return result;
+}
+
+double binomialProbability(size_t n, size_t w, double p) {
+    if (p <= 0.0) return w == 0 ? 1.0 : 0.0;
+    if (p >= 1.0) return w == n ? 1.0 : 0.0;
+    double logCoefficient = std::lgamma(n + 1.0) - std::lgamma(w + 1.0) - std::lgamma(n - w + 1.0);
+    return std::exp(logCoefficient + w * std::log(p) + (n - w) * std::log1p(-p));
+}
+
+std::vector<FailureEstimate> estimateFailureRatesStratified(const std::vector<double>& errorRates, const matrix& h,
+                                                            const SyndromeTable& table, size_t sampleCount, uint64_t seed) {
+    size_t n = h.cols();
+
+    // importance of every weight: its biggest probability over the error rates
+    std::vector<double> importance(n + 1, 0.0);
+    for (size_t w = 1; w <= n; w++) {
+        for (double p : errorRates) importance[w] = std::max(importance[w], binomialProbability(n, w, p));
+    }
+    double importanceSum = std::accumulate(importance.begin(), importance.end(), 0.0);
+
+    std::mt19937_64 generator(seed);
+    std::vector<double> failureFraction(n + 1, 0.0), fractionVariance(n + 1, 0.0);
+    std::vector<vec> errorVectors, decoded;
+    std::vector<size_t> positions(n);
+    for (size_t w = 1; w <= n; w++) {
+        size_t samples = std::max<size_t>(1, static_cast<size_t>(sampleCount * importance[w] / importanceSum));
+        double patternCount = std::exp(std::lgamma(n + 1.0) - std::lgamma(w + 1.0) - std::lgamma(n - w + 1.0));
+
+        errorVectors.clear();
+        bool exhaustive = patternCount <= samples;
+        if (exhaustive) {
+            // every weight w vector in increasing order (next bit permutation)
+            vec e = (w == 64 ? ~vec{0} : (vec{1} << w) - 1);
+            vec last = e << (n - w);
+            while (true) {
+                errorVectors.push_back(e);
+                if (e == last) break;
+                vec lowest = e & (~e + 1);
+                vec ripple = e + lowest;
+                e = ripple | (((e ^ ripple) >> 2) / lowest);
+            }
+        } else {
+            // w distinct random positions, partial Fisher-Yates shuffle
+            std::iota(positions.begin(), positions.end(), 0);
+            for (size_t i = 0; i < samples; i++) {
+                vec e = 0;
+                for (size_t j = 0; j < w; j++) {
+                    size_t pick = j + generator() % (n - j);
+                    std::swap(positions[j], positions[pick]);
+                    e |= vec{1} << positions[j];
+                }
+                errorVectors.push_back(e);
+            }
+        }
+
+        decoded.resize(errorVectors.size());
+        decodeBatch(errorVectors, decoded, table, h);
+        size_t failures = std::count_if(decoded.begin(), decoded.end(), [](vec m) { return m != 0; });
+        double f = static_cast<double>(failures) / errorVectors.size();
+        failureFraction[w] = f;
+        // sampled fraction has binomial variance, with finite population correction;
+        // half a failure is added for the variance only, so strata that always (or never) failed don't claim zero variance
+        if (!exhaustive) {
+            double smoothed = (failures + 0.5) / (errorVectors.size() + 1.0);
+            fractionVariance[w] = smoothed * (1.0 - smoothed) / errorVectors.size() * (1.0 - errorVectors.size() / patternCount);
+        }
+    }
+
+    std::vector<FailureEstimate> estimates;
+    for (double p : errorRates) {
+        double rate = 0.0, variance = 0.0;
+        for (size_t w = 1; w <= n; w++) {
+            double probability = binomialProbability(n, w, p);
+            rate += probability * failureFraction[w];
+            variance += probability * probability * fractionVariance[w];
+        }
+        estimates.push_back({ p, rate, std::sqrt(variance) });
+    }
+    return estimates;
+}
+
+void benchmarkImportanceSampling(const std::vector<double>& errorRates, size_t n, size_t k,
+                                 size_t sampleCount, uint64_t seed) {
+    matrix g = matrix(k, k, true).append(randomMatrix(k, n - k, seed));
+    matrix h = calculateControlMatrix(g);
+    LocalSyndromeTable local = makeLocalSyndromeTable(calculateSyndromes(h), h);
+
+    std::print("N: {}, K: {}, {} vectors per estimate\n", n, k, sampleCount);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::vector<FailureEstimate> estimates = estimateFailureRatesStratified(errorRates, local.h, local.table, sampleCount, seed);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::print("  stratified estimates took {:.2f}ms for all error rates\n", std::chrono::duration<double, std::milli>(end - begin).count());
+
+    std::print("  {:>8} | {:>12} {:>10} | {:>12} {:>10} | {:>14}\n", "p", "stratified", "std err", "monte carlo", "std err", "mc vectors needed");
+    Channel c(seed + 1);
+    std::vector<vec> received(sampleCount), decoded(sampleCount);
+    for (const FailureEstimate& estimate : estimates) {
+        for (vec& r : received) r = c.sendVector(0, n, estimate.p);
+        decodeBatch(received, decoded, local.table, local.h);
+        double rate = static_cast<double>(std::count_if(decoded.begin(), decoded.end(), [](vec m) { return m != 0; })) / sampleCount;
+        double standardError = std::sqrt(rate * (1.0 - rate) / sampleCount);
+
+        // plain Monte Carlo needs rate * (1 - rate) / error^2 vectors for the same standard error
+        std::string needed = "-";
+        if (estimate.standardError > 0) {
+            needed = std::format("{:.3g}", estimate.rate * (1.0 - estimate.rate) / (estimate.standardError * estimate.standardError));
+        }
+        std::print("  {:>8} | {:>12.4e} {:>10.2e} | {:>12.4e} {:>10.2e} | {:>14}\n", estimate.p, estimate.rate,
+                   estimate.standardError, rate, standardError, needed);
+    }
+}
+
+// One finished point of a sweep, as stored in sweep log.
+struct SweepPoint {
+    size_t n, k;
+    double p;
+    uint64_t seed;
+    int64_t vecCount;
+    int64_t errors;
+    double syndromeGenTimeMs;
+    double testRunTimeMs;
+    PerfCounterValues decodeCounters; // empty if counters were not read
+};
+
+// Counter columns are in the order of PerfEvent and are left empty if counter was not read.
+constexpr std::string_view sweepLogHeader = "n,k,p,seed,vec_count,errors,syndrome_gen_time_ms,test_run_time_ms,"
+                                            "decode_cycles,decode_instructions,decode_l1d_misses,decode_llc_misses,decode_branch_misses";
+// Header of logs written before counter columns were added, their points have no counters.
+constexpr std::string_view sweepLogHeaderWithoutCounters = "n,k,p,seed,vec_count,errors,syndrome_gen_time_ms,test_run_time_ms";
+
+// Number of vectors sent for every sweep point.
+constexpr size_t sweepVecCount = 125'000;
+
+// Returns key identifying a sweep point.
+static std::string sweepPointKey(size_t n, size_t k, double p, uint64_t seed) {
+    return std::format("{},{},{},{}", n, k, p, seed);
+}
+
+// Reads all complete points from sweep log.
+// Lines that were cut off (e.g. program was killed while writing) are ignored.
+// args:
+//   path - path of sweep log.
+// returns:
+//   std::vector<SweepPoint> - points found in log.
+static std::vector<SweepPoint> readSweepLog(const std::string& path) {
+    std::vector<SweepPoint> points;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line == sweepLogHeader || line == sweepLogHeaderWithoutCounters) continue;
+        SweepPoint point{};
+        int length = 0;
+        int read = std::sscanf(line.c_str(), "%zu,%zu,%lf,%llu,%lld,%lld,%lf,%lf%n", &point.n, &point.k, &point.p,
+                               reinterpret_cast<unsigned long long*>(&point.seed), reinterpret_cast<long long*>(&point.vecCount),
+                               reinterpret_cast<long long*>(&point.errors), &point.syndromeGenTimeMs, &point.testRunTimeMs, &length);
+        if (read != 8) continue;
+
+        // counter columns, missing in logs written before they were added; cut off lines don't have all of them
+        std::string_view rest = std::string_view(line).substr(length);
+        size_t columns = 0;
+        bool valid = true;
+        while (valid && !rest.empty() && columns < point.decodeCounters.values.size()) {
+            size_t end = std::min(rest.find(',', 1), rest.size());
+            std::string_view field = rest.substr(1, end - 1);
+            std::optional<uint64_t>& value = point.decodeCounters.values[columns++];
+            if (!field.empty()) {
+                auto [parsedEnd, error] = std::from_chars(field.data(), field.data() + field.size(), value.emplace());
+                valid = error == std::errc() && parsedEnd == field.data() + field.size();
+            }
+            valid = valid && rest[0] == ',';
+            rest.remove_prefix(end);
+        }
+        if (valid && rest.empty() && (columns == 0 || columns == point.decodeCounters.values.size())) points.push_back(point);
+    }
+    return points;
+}
+
+// Opens sweep log for appending. Writes header if log is new,
+// and ends a cut off last line, so new points start on their own line.
+// args:
+//   path - path of sweep log.
+// returns:
+//   std::ofstream - opened log.
+static std::ofstream openSweepLog(const std::string& path) {
+    std::ifstream existing(path, std::ios::binary | std::ios::ate);
+    bool isNew = !existing || existing.tellg() == 0;
+    bool endsWithNewline = true;
+    if (!isNew) {
+        existing.seekg(-1, std::ios::end);
+        endsWithNewline = existing.get() == '\n';
+    }
+    existing.close();
+
+    std::ofstream file(path, std::ios::app);
+    if (isNew) file << sweepLogHeader << '\n';
+    else if (!endsWithNewline) file << '\n';
+    return file;
+}
+
+// Formats line of sweep log.
+static std::string sweepLogLine(size_t n, size_t k, double p, uint64_t seed, int64_t vecCount, int64_t errors,
+                                double syndromeGenTimeMs, double testRunTimeMs, const PerfCounterValues& decodeCounters) {
+    std::string line = std::format("{},{},{},{:f},{:f}", sweepPointKey(n, k, p, seed), vecCount, errors, syndromeGenTimeMs, testRunTimeMs);
+    for (const std::optional<uint64_t>& value : decodeCounters.values) {
+        line += value ? std::format(",{}", *value) : ",";
+    }
+    line += '\n';
+    return line;
+}
+
+// Returns generator matrix of sweep cell. Same (n, k, seed) always gives the same matrix.
+static matrix sweepCellMatrix(size_t n, size_t k, uint64_t seed) {
+    std::seed_seq codeSeed{ n, k, seed };
+    uint32_t matrixSeed;
+    codeSeed.generate(&matrixSeed, &matrixSeed + 1);
+    return matrix(k, k, true).append(randomMatrix(k, n - k, matrixSeed));
+}
+
+// Random messages and channel of one sweep point.
+struct SweepPointRandom {
+    std::default_random_engine messages;
+    Channel channel;
+};
+
+// Returns random messages and channel of sweep point. Same point always gets the same messages and errors.
+static SweepPointRandom sweepPointRandom(size_t n, size_t k, double p, uint64_t seed) {
+    std::seed_seq pointSeed{ static_cast<uint64_t>(n), static_cast<uint64_t>(k), seed, std::bit_cast<uint64_t>(p) };
+    uint32_t seeds[2];
+    pointSeed.generate(std::begin(seeds), std::end(seeds));
+    return { std::default_random_engine(seeds[0]), Channel(seeds[1]) };
+}
+
+// Sends vectors of sweep point through channel and counts decoding errors.
+// Calling it several times on the same SweepPointRandom continues the same sequence of vectors.
+// Vectors are generated first and then decoded, so counters cover only decoding.
+// args:
+//   random - messages and channel of sweep point.
+//   vecCount - number of vectors to send.
+//   n, k - code parameters.
+//   p - probability of errors.
+//   gTransposed - transposed generator matrix.
+//   h - control matrix.
+//   syndromes - syndromes of code.
+//   counters - counters to read around decoding, nullptr to not read them.
+//   decodeCounters - gets set to counted values, if counters are read.
+// returns:
+//   int64_t - number of wrongly decoded vectors.
+static int64_t countSweepErrors(SweepPointRandom& random, size_t vecCount, size_t n, size_t k, double p,
+                                const matrix& gTransposed, const matrix& h, const Syndromes& syndromes,
+                                PerfCounters* counters, PerfCounterValues& decodeCounters) {
+    std::vector<vec> originals(vecCount), received(vecCount);
+    for (size_t i = 0; i < vecCount; i++) {
+        originals[i] = random.messages() % (1ULL << k);
+        received[i] = random.channel.sendVector(encode(originals[i], gTransposed), n, p);
+    }
+
+    if (counters) counters->start();
+    int64_t errors = 0;
+    for (size_t i = 0; i < vecCount; i++) {
+        if (originals[i] != decode(received[i], syndromes, h)) errors++;
+    }
+    if (counters) decodeCounters = counters->stop();
+    return errors;
+}
+
+// Writes averages of every (n, k) cell over seeds from sweep log to results.txt.
+// Hardware counters are given per decoded vector, over points that have them ("-" if none has).
+// args:
+//   errorRates - error probabilities of sweep.
+//   maxN, maxK, repetitions - size of sweep, points outside of it are ignored.
+//   logPath - path of sweep log.
+static void writeSweepSummary(const std::vector<double>& errorRates, size_t maxN, size_t maxK, size_t repetitions, const std::string& logPath) {
+    // average every (n, k) cell over seeds
+    std::map<std::pair<size_t, size_t>, std::vector<SweepPoint>> cells;
+    for (const SweepPoint& point : readSweepLog(logPath)) {
+        if (point.n >= maxN || point.k >= maxK || point.seed >= repetitions) continue;
+        if (std::find(errorRates.begin(), errorRates.end(), point.p) == errorRates.end()) continue;
+        cells[{ point.n, point.k }].push_back(point);
+    }
+
+    std::ofstream file("results.txt");
+    std::ostream_iterator<char> fileOut(file);
+
+    std::format_to(fileOut, "ERROR_RATES=");
+    for (double p : errorRates) {
+        std::format_to(fileOut, "{}{}", p, p == errorRates.back() ? "\n" : " ");
+    }
+    std::format_to(fileOut, " N | K | VEC_COUNT | SYNDROME_GEN_TIME_MS | TEST_RUN_TIME_MS | DECODE_CYCLES | DECODE_IPC "
+                            "| DECODE_L1D_MISSES | DECODE_LLC_MISSES | DECODE_BRANCH_MISSES | DECODE_RATES\n");
+    for (const auto& [nk, points] : cells) {
+        batch b{};
+        b.totalVecCount = 0;
+        b.syndromeGenTimeMs = 0;
+        b.testRunTimeMs = 0;
+        b.successfulDecodeRates.assign(errorRates.size(), 0.0);
+        std::vector<size_t> seedCounts(errorRates.size(), 0);
+        std::unordered_set<uint64_t> seeds;
+        int64_t counterVecCount = 0;
+        for (const SweepPoint& point : points) {
+            if (point.decodeCounters.get(PerfEvent::cycles)) {
+                if (counterVecCount == 0) b.decodeCounters = point.decodeCounters;
+                else b.decodeCounters.add(point.decodeCounters);
+                counterVecCount += point.vecCount;
+            }
+            size_t i = std::find(errorRates.begin(), errorRates.end(), point.p) - errorRates.begin();
+            b.successfulDecodeRates[i] += (1.0 - static_cast<double>(point.errors) / point.vecCount) * 100.0;
+            seedCounts[i]++;
+            b.testRunTimeMs += point.testRunTimeMs;
+            if (seeds.insert(point.seed).second) b.syndromeGenTimeMs += point.syndromeGenTimeMs;
+            if (point.seed == points.front().seed) b.totalVecCount += point.vecCount;
+        }
+        for (size_t i = 0; i < errorRates.size(); i++) {
+            if (seedCounts[i] != 0) b.successfulDecodeRates[i] /= seedCounts[i];
+        }
+        b.syndromeGenTimeMs /= seeds.size();
+        b.testRunTimeMs /= seeds.size();
+
+        std::format_to(fileOut, "{} {} {} {:f} {:f} ", nk.first, nk.second, b.totalVecCount, b.syndromeGenTimeMs, b.testRunTimeMs);
+        auto perVector = [&](PerfEvent event) -> std::string {
+            std::optional<uint64_t> value = b.decodeCounters.get(event);
+            return value && counterVecCount != 0 ? std::format("{:f}", static_cast<double>(*value) / counterVecCount) : "-";
+        };
+        std::optional<uint64_t> cycles = b.decodeCounters.get(PerfEvent::cycles);
+        std::optional<uint64_t> instructions = b.decodeCounters.get(PerfEvent::instructions);
+        std::string ipc = cycles && instructions && *cycles != 0 ? std::format("{:f}", static_cast<double>(*instructions) / *cycles) : "-";
+        std::format_to(fileOut, "{} {} {} {} {} ", perVector(PerfEvent::cycles), ipc, perVector(PerfEvent::l1dMisses),
+                       perVector(PerfEvent::llcMisses), perVector(PerfEvent::branchMisses));
+        for (size_t i = 0; i < b.successfulDecodeRates.size(); i++) {
+            std::format_to(fileOut, "{:f}{}", b.successfulDecodeRates[i], i == b.successfulDecodeRates.size() - 1 ? "\n" : " ");
+        }
+    }
+}
+
+void benchmark(const std::vector<double>& errorRates, size_t maxN, size_t maxK, size_t repetitions,
+               const std::string& logPath, bool readCounters) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::unordered_set<std::string> done;
+    for (const SweepPoint& point : readSweepLog(logPath)) {
+        done.insert(sweepPointKey(point.n, point.k, point.p, point.seed));
+    }
+    std::print("Found {} finished points in '{}'\n", done.size(), logPath);
+
+    std::ofstream log = openSweepLog(logPath);
+    size_t vecCount = sweepVecCount;
+    std::optional<PerfCounters> counters;
+    if (readCounters) counters.emplace();
+    for (uint64_t seed = 0; seed < repetitions; seed++) {
+        for (size_t n = 2; n < maxN; n++) {
+            for (size_t k = 1; k <= n && k < maxK; k++) {
+                std::vector<double> pending;
+                for (double p : errorRates) {
+                    if (!done.contains(sweepPointKey(n, k, p, seed))) pending.push_back(p);
+                }
+                if (pending.empty()) continue;
+
+                matrix g = sweepCellMatrix(n, k, seed);
+                matrix gTransposed = g.transpose();
+                matrix h = calculateControlMatrix(g);
+
+                std::print("N: {}, K: {}, seed: {}\n", n, k, seed);
+                std::chrono::steady_clock::time_point genBegin = std::chrono::steady_clock::now();
+                Syndromes syndromes = calculateSyndromes(h);
+                std::chrono::steady_clock::time_point genEnd = std::chrono::steady_clock::now();
+                double syndromeGenTimeMs = std::chrono::duration<double, std::milli>(genEnd - genBegin).count();
+
+                for (double p : pending) {
+                    SweepPointRandom random = sweepPointRandom(n, k, p, seed);
+                    std::chrono::steady_clock::time_point runBegin = std::chrono::steady_clock::now();
+                    PerfCounterValues decodeCounters;
+                    int64_t errors = countSweepErrors(random, vecCount, n, k, p, gTransposed, h, syndromes,
+                                                      counters ? &*counters : nullptr, decodeCounters);
+                    std::chrono::steady_clock::time_point runEnd = std::chrono::steady_clock::now();
+                    double testRunTimeMs = std::chrono::duration<double, std::milli>(runEnd - runBegin).count();
+
+                    log << sweepLogLine(n, k, p, seed, vecCount, errors, syndromeGenTimeMs, testRunTimeMs, decodeCounters);
+                    log.flush();
+                }
+            }
+        }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::print("Benchmark finished in {}ms\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+    log.close();
+    writeSweepSummary(errorRates, maxN, maxK, repetitions, logPath);
+}
+
+#ifdef __linux__
+
+// State of one sweep cell (n, k, seed) of sharded sweep, kept in memory shared by all processes.
+struct ShardCellState {
+    std::atomic<int32_t> owner; // 0 if waiting in queue, pid of worker computing it, shardCellDone or shardCellFailed
+    std::atomic<uint32_t> attempts; // number of workers that died while computing it
+    double syndromeGenTimeMs;
+};
+constexpr int32_t shardCellDone = -1;
+constexpr int32_t shardCellFailed = -2;
+// cell is given up after this many workers die on it (e.g. its syndromes don't fit into memory limit)
+constexpr uint32_t shardCellMaxAttempts = 3;
+
+// Results of one sweep point of sharded sweep, kept in shared memory. Errors are added while vectors are being sent.
+struct ShardPointState {
+    std::atomic<int64_t> errors;
+    std::atomic<int64_t> vecCount;
+    double testRunTimeMs;
+    PerfCounterValues decodeCounters; // set with testRunTimeMs, empty if counters were not read
+};
+static_assert(std::atomic<int32_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free,
+              "atomics shared between processes must be lock free");
+
+// Sweep cell. Coordinator fills them before forking, so every worker has its own copy.
+struct ShardCell {
+    size_t n, k;
+    uint64_t seed;
+    std::vector<double> pending; // error probabilities not in sweep log yet
+    size_t firstPoint; // index of first point in shared results
+};
+
+// Worker process of sharded sweep. Claims waiting cells one by one (owner 0 -> own pid) until none are left.
+// Errors are added to shared results every few thousand vectors, so coordinator can show progress.
+// Never returns, exits with code 0 when queue is empty, or 1 if computing a cell failed.
+// args:
+//   cells - cells of sweep.
+//   cellStates - shared states of cells.
+//   pointStates - shared results of points.
+//   memoryLimit - address space limit of worker in bytes, 0 for no limit.
+//   readCounters - read hardware counters around decoding.
+[[noreturn]] static void shardWorker(std::span<const ShardCell> cells, ShardCellState* cellStates, ShardPointState* pointStates,
+                                     size_t memoryLimit, bool readCounters) {
+    constexpr size_t chunkSize = 4096;
+    if (memoryLimit != 0) {
+        rlimit limit{ memoryLimit, memoryLimit };
+        setrlimit(RLIMIT_AS, &limit);
+    }
+    int32_t pid = getpid();
+    try {
+        // counters count only the thread that opened them, so every worker opens its own
+        std::optional<PerfCounters> counters;
+        if (readCounters) counters.emplace();
+        while (true) {
+            size_t index = 0;
+            for (int32_t waiting = 0; index < cells.size(); index++, waiting = 0) {
+                if (cellStates[index].owner.compare_exchange_strong(waiting, pid)) break;
+            }
+            if (index == cells.size()) break;
+
+            const ShardCell& cell = cells[index];
+            matrix g = sweepCellMatrix(cell.n, cell.k, cell.seed);
+            matrix gTransposed = g.transpose();
+            matrix h = calculateControlMatrix(g);
+            std::chrono::steady_clock::time_point genBegin = std::chrono::steady_clock::now();
+            Syndromes syndromes = calculateSyndromes(h);
+            std::chrono::steady_clock::time_point genEnd = std::chrono::steady_clock::now();
+            cellStates[index].syndromeGenTimeMs = std::chrono::duration<double, std::milli>(genEnd - genBegin).count();
+
+            for (size_t i = 0; i < cell.pending.size(); i++) {
+                ShardPointState& point = pointStates[cell.firstPoint + i];
+                SweepPointRandom random = sweepPointRandom(cell.n, cell.k, cell.pending[i], cell.seed);
+                PerfCounterValues decodeCounters, chunkCounters;
+                std::chrono::steady_clock::time_point runBegin = std::chrono::steady_clock::now();
+                for (size_t sent = 0; sent < sweepVecCount; sent += chunkSize) {
+                    size_t size = std::min(chunkSize, sweepVecCount - sent);
+                    point.errors += countSweepErrors(random, size, cell.n, cell.k, cell.pending[i], gTransposed, h, syndromes,
+                                                     counters ? &*counters : nullptr, chunkCounters);
+                    point.vecCount += size;
+                    if (sent == 0) decodeCounters = chunkCounters;
+                    else decodeCounters.add(chunkCounters);
+                }
+                std::chrono::steady_clock::time_point runEnd = std::chrono::steady_clock::now();
+                point.testRunTimeMs = std::chrono::duration<double, std::milli>(runEnd - runBegin).count();
+                point.decodeCounters = decodeCounters;
+            }
+            // release, so coordinator sees all results once it sees the cell done
+            cellStates[index].owner.store(shardCellDone, std::memory_order_release);
+        }
+    } catch (const std::exception& e) {
+        std::print(stderr, "Worker {} failed: {}\n", pid, e.what());
+        _exit(1);
+    }
+    _exit(0);
+}
+
+void benchmarkSharded(const std::vector<double>& errorRates, size_t maxN, size_t maxK, size_t repetitions,
+                      size_t workerCount, size_t memoryLimit, const std::string& logPath, bool readCounters) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::unordered_set<std::string> done;
+    for (const SweepPoint& point : readSweepLog(logPath)) {
+        done.insert(sweepPointKey(point.n, point.k, point.p, point.seed));
+    }
+
+    std::vector<ShardCell> cells;
+    size_t pointCount = 0;
+    for (uint64_t seed = 0; seed < repetitions; seed++) {
+        for (size_t n = 2; n < maxN; n++) {
+            for (size_t k = 1; k <= n && k < maxK; k++) {
+                ShardCell cell{ n, k, seed, {}, pointCount };
+                for (double p : errorRates) {
+                    if (!done.contains(sweepPointKey(n, k, p, seed))) cell.pending.push_back(p);
+                }
+                if (cell.pending.empty()) continue;
+                pointCount += cell.pending.size();
+                cells.push_back(std::move(cell));
+            }
+        }
+    }
+    std::print("Found {} finished points in '{}', {} cells to compute with {} workers\n", done.size(), logPath, cells.size(), workerCount);
+
+    // shared memory is inherited by forked workers, anonymous mapping starts zeroed
+    size_t cellBytes = cells.size() * sizeof(ShardCellState);
+    size_t sharedSize = std::max<size_t>(cellBytes + pointCount * sizeof(ShardPointState), 1);
+    void* shared = mmap(nullptr, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        std::print("Failed to map shared memory\n");
+        return;
+    }
+    ShardCellState* cellStates = static_cast<ShardCellState*>(shared);
+    ShardPointState* pointStates = reinterpret_cast<ShardPointState*>(static_cast<uint8_t*>(shared) + cellBytes);
+    for (size_t i = 0; i < cells.size(); i++) new (&cellStates[i]) ShardCellState{};
+    for (size_t i = 0; i < pointCount; i++) new (&pointStates[i]) ShardPointState{};
+
+    std::ofstream log = openSweepLog(logPath);
+    std::set<pid_t> workers;
+    auto startWorker = [&] {
+        std::fflush(stdout); // otherwise worker would print buffered output again
+        pid_t pid = fork();
+        if (pid == 0) shardWorker(cells, cellStates, pointStates, memoryLimit, readCounters);
+        if (pid > 0) workers.insert(pid);
+        else std::print("Failed to start worker\n");
+        return pid > 0;
+    };
+    for (size_t i = 0; i < std::min(workerCount, cells.size()); i++) startWorker();
+
+    std::vector<bool> logged(cells.size(), false);
+    size_t loggedCount = 0;
+    while (!workers.empty()) {
+        // reap finished workers, cells of dead ones go back to the queue
+        int status;
+        for (pid_t pid; (pid = waitpid(-1, &status, WNOHANG)) > 0;) {
+            workers.erase(pid);
+            for (size_t i = 0; i < cells.size(); i++) {
+                if (cellStates[i].owner.load() != pid) continue;
+                for (size_t j = 0; j < cells[i].pending.size(); j++) {
+                    pointStates[cells[i].firstPoint + j].errors = 0;
+                    pointStates[cells[i].firstPoint + j].vecCount = 0;
+                }
+                bool giveUp = ++cellStates[i].attempts >= shardCellMaxAttempts;
+                std::print("\nWorker {} died ({} {}) on N: {}, K: {}, seed: {}, {}\n", pid,
+                           WIFSIGNALED(status) ? "signal" : "exit code", WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status),
+                           cells[i].n, cells[i].k, cells[i].seed, giveUp ? "giving up" : "cell re-queued");
+                cellStates[i].owner = giveUp ? shardCellFailed : 0;
+            }
+        }
+        // replace dead workers while cells wait in queue, also when a worker died on a cell that was given up,
+        // so no queued cell is left without a worker
+        size_t queued = std::count_if(cellStates, cellStates + cells.size(), [](const ShardCellState& state) { return state.owner.load() == 0; });
+        while (workers.size() < std::min(workerCount, queued) && startWorker()) {}
+
+        // write finished cells to log
+        int64_t sentCount = 0;
+        for (size_t i = 0; i < cells.size(); i++) {
+            for (size_t j = 0; j < cells[i].pending.size(); j++) sentCount += pointStates[cells[i].firstPoint + j].vecCount;
+            if (logged[i] || cellStates[i].owner.load(std::memory_order_acquire) != shardCellDone) continue;
+            for (size_t j = 0; j < cells[i].pending.size(); j++) {
+                const ShardPointState& point = pointStates[cells[i].firstPoint + j];
+                log << sweepLogLine(cells[i].n, cells[i].k, cells[i].pending[j], cells[i].seed, point.vecCount.load(), point.errors.load(),
+                                    cellStates[i].syndromeGenTimeMs, point.testRunTimeMs, point.decodeCounters);
+            }
+            log.flush();
+            logged[i] = true;
+            loggedCount++;
+        }
+        std::print("\rCells: {}/{}, vectors sent: {}, workers: {}   ", loggedCount, cells.size(), sentCount, workers.size());
+        std::fflush(stdout);
+        if (!workers.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    munmap(shared, sharedSize);
+    log.close();
+    size_t failedCount = cells.size() - loggedCount; // given up, or left in queue if workers could not be started
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::print("\nBenchmark finished in {}ms, {} cells failed\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count(), failedCount);
+    writeSweepSummary(errorRates, maxN, maxK, repetitions, logPath);
+}
+
+#endif
+
+void benchmarkBatchDecode(size_t n, size_t k, double p, size_t vecCount) {
+    matrix g = matrix(k, k, true).append(randomMatrix(k, n - k));
+    matrix gTransposed = g.transpose();
+    matrix h = calculateControlMatrix(g);
+    Syndromes syndromes = calculateSyndromes(h);
+    LocalSyndromeTable local = makeLocalSyndromeTable(syndromes, h);
+
+    Channel c;
+    std::vector<vec> received(vecCount);
+    for (vec& r : received) {
+        r = c.sendVector(encode(std::rand() % (1ULL << k), gTransposed), n, p);
+    }
+
+    std::print("N: {}, K: {}, p: {}\n", n, k, p);
+    PerfCounters counters;
+    std::vector<vec> expected(vecCount);
+    counters.start();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < vecCount; i++) {
+        expected[i] = decode(received[i], syndromes, h);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    PerfCounterValues values = counters.stop();
+    double decodeMs = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::print("  {:>8}: {:10.2f} Mvec/s\n", "decode", vecCount / decodeMs / 1000.0);
+    printPerfCounters("decode", values, vecCount);
+
+    std::vector<vec> decoded(vecCount);
+    for (SimdLevel level : { SimdLevel::scalar, SimdLevel::avx2, SimdLevel::avx512 }) {
+        if (level > detectSimdLevel()) continue;
+        counters.start();
+        begin = std::chrono::steady_clock::now();
+        decodeBatch(received, decoded, local.table, local.h, level);
+        end = std::chrono::steady_clock::now();
+        values = counters.stop();
+        double batchMs = std::chrono::duration<double, std::milli>(end - begin).count();
+        bool identical = decoded == expected;
+        std::print("  {:>8}: {:10.2f} Mvec/s ({:.2f}x){}\n", simdLevelName(level), vecCount / batchMs / 1000.0,
+                   decodeMs / batchMs, identical ? "" : " MISMATCH");
+        printPerfCounters(simdLevelName(level), values, vecCount);
+    }
+}
+
+void benchmarkSyndromeLayout(size_t n, size_t k, double p, size_t vecCount) {
+    matrix g = matrix(k, k, true).append(randomMatrix(k, n - k));
+    matrix gTransposed = g.transpose();
+    matrix h = calculateControlMatrix(g);
+    SyndromeTable table = makeSyndromeTable(calculateSyndromes(h), n - k);
+    LocalSyndromeTable local = localizeSyndromeTable(table, h);
+
+    Channel c;
+    std::vector<vec> received(vecCount);
+    for (vec& r : received) {
+        r = c.sendVector(encode(std::rand() % (1ULL << k), gTransposed), n, p);
+    }
+
+    std::print("N: {}, K: {}, p: {}, table: {} MiB\n", n, k, p, table.size() >> 20);
+    PerfCounters counters;
+    std::vector<vec> plainDecoded(vecCount), localDecoded(vecCount);
+    for (SimdLevel level : { SimdLevel::scalar, SimdLevel::avx2, SimdLevel::avx512 }) {
+        if (level > detectSimdLevel()) continue;
+        counters.start();
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        decodeBatch(received, plainDecoded, table, h, level);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        PerfCounterValues plainValues = counters.stop();
+        double plainMs = std::chrono::duration<double, std::milli>(end - begin).count();
+
+        counters.start();
+        begin = std::chrono::steady_clock::now();
+        decodeBatch(received, localDecoded, local.table, local.h, level);
+        end = std::chrono::steady_clock::now();
+        PerfCounterValues localValues = counters.stop();
+        double localMs = std::chrono::duration<double, std::milli>(end - begin).count();
+
+        std::print("  {:>8}: plain {:10.2f} Mvec/s, local {:10.2f} Mvec/s ({:.2f}x){}\n", simdLevelName(level), vecCount / plainMs / 1000.0,
+                   vecCount / localMs / 1000.0, plainMs / localMs, plainDecoded == localDecoded ? "" : " MISMATCH");
+        printPerfCounters(std::format("{} plain", simdLevelName(level)), plainValues, vecCount);
+        printPerfCounters(std::format("{} local", simdLevelName(level)), localValues, vecCount);
+    }
+}
+
+void benchmarkMlDecode(size_t n, size_t k, double p, size_t vecCount) {
+    matrix g = matrix(k, k, true).append(randomMatrix(k, n - k));
+    matrix gTransposed = g.transpose();
+    matrix h = calculateControlMatrix(g);
+    Syndromes syndromes = calculateSyndromes(h);
+    LocalSyndromeTable local = makeLocalSyndromeTable(syndromes, h);
+    MlDecoder mlDecoder(gTransposed);
+
+    Channel c;
+    std::vector<vec> messages(vecCount), received(vecCount), decoded(vecCount);
+    for (size_t i = 0; i < vecCount; i++) {
+        messages[i] = std::rand() % (1ULL << k);
+        received[i] = c.sendVector(encode(messages[i], gTransposed), n, p);
+    }
+    auto errorCount = [&] {
+        size_t errors = 0;
+        for (size_t i = 0; i < vecCount; i++) errors += decoded[i] != messages[i];
+        return errors;
+    };
+
+    std::print("N: {}, K: {}, p: {}\n", n, k, p);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < vecCount; i++) {
+        decoded[i] = decode(received[i], syndromes, h);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double decodeMs = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::print("  {:>10}: {:10.3f} Mvec/s, {} errors\n", "decode", vecCount / decodeMs / 1000.0, errorCount());
+
+    begin = std::chrono::steady_clock::now();
+    decodeBatch(received, decoded, local.table, local.h);
+    end = std::chrono::steady_clock::now();
+    double batchMs = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::print("  {:>10}: {:10.3f} Mvec/s ({:.2f}x), {} errors\n", "batch", vecCount / batchMs / 1000.0, decodeMs / batchMs, errorCount());
+
+    std::vector<vec> expected;
+    for (SimdLevel level : { SimdLevel::scalar, SimdLevel::avx2, SimdLevel::avx512 }) {
+        if (level > detectSimdLevel()) continue;
+        begin = std::chrono::steady_clock::now();
+        mlDecoder.decode(received, decoded, level);
+        end = std::chrono::steady_clock::now();
+        double mlMs = std::chrono::duration<double, std::milli>(end - begin).count();
+        if (expected.empty()) expected = decoded;
+        std::print("  ml {:>7}: {:10.3f} Mvec/s ({:.2f}x), {} errors{}\n", simdLevelName(level), vecCount / mlMs / 1000.0,
+                   decodeMs / mlMs, errorCount(), decoded == expected ? "" : " MISMATCH");
+    }
+}
+
+void compareCodes(const std::vector<double>& errorRates, size_t n, size_t maxK, size_t codesPerK,
+                  size_t vecCount, uint64_t seed) {
+    struct Candidate {
+        size_t k;
+        matrix gTransposed;
+        LocalSyndromeTable local;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t k = 1; k < maxK && k < n; k++) {
+        for (size_t c = 0; c < codesPerK; c++) {
+            matrix g = matrix(k, k, true).append(randomMatrix(k, n - k, seed * 1'000'003 + k * 1'009 + c));
+            matrix h = calculateControlMatrix(g);
+            candidates.push_back({ k, g.transpose(), makeLocalSyndromeTable(calculateSyndromes(h), h) });
+        }
+    }
+
+    std::print("N: {}, {} codes, {} vectors per error rate\n", n, candidates.size(), vecCount);
+    std::vector<vec> messages(vecCount), errorVectors(vecCount), received(vecCount), decoded(vecCount);
+    std::vector<std::vector<uint8_t>> failed(candidates.size(), std::vector<uint8_t>(vecCount));
+    for (double p : errorRates) {
+        // shared stream of messages and errors
+        std::default_random_engine generator(seed);
+        Channel c(seed + 1);
+        for (size_t i = 0; i < vecCount; i++) {
+            messages[i] = (static_cast<vec>(generator()) << 32) ^ generator();
+            errorVectors[i] = c.sendVector(0, n, p);
+        }
+
+        for (size_t ci = 0; ci < candidates.size(); ci++) {
+            const Candidate& cand = candidates[ci];
+            vec messageMask = (1ULL << cand.k) - 1;
+            for (size_t i = 0; i < vecCount; i++) {
+                received[i] = encode(messages[i] & messageMask, cand.gTransposed) ^ errorVectors[i];
+            }
+            decodeBatch(received, decoded, cand.local.table, cand.local.h);
+            for (size_t i = 0; i < vecCount; i++) {
+                failed[ci][i] = decoded[i] != (messages[i] & messageMask);
+            }
+        }
+
+        std::print("  p = {}\n", p);
+        std::print("  {:>6} {:>6} | {:>9} {:>9} | {:>22} | {:>12}\n", "k(a)", "k(b)", "fail(a)%", "fail(b)%", "a-b % (95% CI)", "vec. saved");
+        for (size_t ci = 0; ci + 1 < candidates.size(); ci++) {
+            const std::vector<uint8_t>& a = failed[ci];
+            const std::vector<uint8_t>& b = failed[ci + 1];
+            double failA = 0, failB = 0, diffMean = 0, diffSquares = 0;
+            for (size_t i = 0; i < vecCount; i++) {
+                double d = static_cast<double>(a[i]) - b[i];
+                failA += a[i];
+                failB += b[i];
+                diffMean += d;
+                diffSquares += d * d;
+            }
+            failA /= vecCount;
+            failB /= vecCount;
+            diffMean /= vecCount;
+            double diffVariance = vecCount > 1 ? (diffSquares - vecCount * diffMean * diffMean) / (vecCount - 1) : 0.0;
+            double pairedError = std::sqrt(diffVariance / vecCount);
+            // what the variance would be if both codes had their own noise
+            double independentVariance = failA * (1 - failA) + failB * (1 - failB);
+            std::string saved = diffVariance > 0 ? std::format("{:.1f}x", independentVariance / diffVariance) : "-";
+
+            std::print("  {:>6} {:>6} | {:>9.3f} {:>9.3f} | {:>8.3f} +- {:<10.3f} | {:>12}\n", candidates[ci].k, candidates[ci + 1].k,
+                       failA * 100.0, failB * 100.0, diffMean * 100.0, 1.96 * pairedError * 100.0, saved);
+        }
+    }
+}
+
+void benchmarkCyclic(size_t n, vec generator, size_t vecCount) {
+    CyclicCode code(n, generator);
+    size_t k = code.k();
+    matrix g = matrix(k, k, true).append(code.generatorMatrixA());
+    matrix gTransposed = g.transpose();
+    matrix h = calculateControlMatrix(g);
+    std::print("N: {}, K: {}, g(x): {}\n", n, k, printVec(generator, n - k + 1));
+
+    auto measure = [&](std::string_view name, auto&& fn) {
+        vec checksum = 0;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < vecCount; i++) checksum ^= fn(static_cast<vec>(i) * 0x9E3779B97F4A7C15ULL);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+        std::print("  {:>16}: {:10.2f} Mvec/s (checksum {:x})\n", name, vecCount / ms / 1000.0, checksum);
+    };
+    vec messageMask = (1ULL << k) - 1;
+    vec codewordMask = n == 64 ? ~vec{0} : (1ULL << n) - 1;
+    measure("encode (matrix)", [&](vec v) { return encode(v & messageMask, gTransposed); });
+    measure("encode (cyclic)", [&](vec v) { return code.encode(v & messageMask); });
+    measure("syndrome (matrix)", [&](vec v) { return h.multVectorOnRight(v & codewordMask); });
+    measure("syndrome (cyclic)", [&](vec v) { return code.syndrome(v & codewordMask); });
+}
+
+// Error rates of the stats in README.
+static const std::vector<double> defaultErrorRates = { 0.01, 0.02, 0.05, 0.10, 0.15, 0.25, 0.40, 0.50 };
+
+struct BenchmarkArgs {
+    size_t n = 0, k = 0;
+    std::optional<double> p;
+    size_t maxN = 31, maxK = 16; // same size as the stats in README
+    size_t repetitions = 2;
+    size_t workerCount = 4;
+    size_t memoryLimit = 0; // bytes
+    std::string logPath = std::string(defaultSweepLogPath);
+    std::vector<double> errorRates = defaultErrorRates;
+    std::optional<size_t> vecCount; // default of every benchmark if not given
+    std::optional<size_t> sampleCount;
+    uint64_t seed = 0;
+    size_t codesPerK = 1;
+    vec generator = 0;
+    bool readCounters = false;
+};
+
+// Parses number from command line argument.
+// template args:
+//   T - type of number.
+// args:
+//   text - argument.
+//   result - gets set to parsed number.
+//   base - base of integer numbers.
+// returns:
+//   bool - true if whole argument is a number.
+template <typename T>
+static bool parseNumber(std::string_view text, T& result, int base = 10) {
+    std::from_chars_result parsed;
+    if constexpr (std::is_floating_point_v<T>) parsed = std::from_chars(text.data(), text.data() + text.size(), result);
+    else parsed = std::from_chars(text.data(), text.data() + text.size(), result, base);
+    return parsed.ec == std::errc() && parsed.ptr == text.data() + text.size();
+}
+
+// Parses comma separated error probabilities, every one in [0;1].
+static bool parseErrorRates(std::string_view text, std::vector<double>& errorRates) {
+    errorRates.clear();
+    while (true) {
+        size_t comma = text.find(',');
+        double p;
+        if (!parseNumber(text.substr(0, comma), p) || p < 0.0 || p > 1.0) return false;
+        errorRates.push_back(p);
+        if (comma == std::string_view::npos) return true;
+        text.remove_prefix(comma + 1);
+    }
+}
+
+// Parses flags of benchmark subcommand (everything after argv[2]).
+// args:
+//   argc - number of command line arguments.
+//   argv - command line arguments.
+//   args - gets set to parsed flags.
+// returns:
+//   bool - true if all flags are known and have valid values.
+static bool parseBenchmarkArgs(int argc, char** argv, BenchmarkArgs& args) {
+    for (int i = 3; i < argc; i++) {
+        std::string_view flag = argv[i];
+        if (flag == "--counters") {
+            args.readCounters = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::print(stderr, "Klaida! Nenurodyta '{}' reiksme.\n", flag);
+            return false;
+        }
+        std::string_view value = argv[++i];
+        bool valid = true;
+        if (flag == "-n") valid = parseNumber(value, args.n);
+        else if (flag == "-k") valid = parseNumber(value, args.k);
+        else if (flag == "-p") valid = parseNumber(value, args.p.emplace()) && *args.p >= 0.0 && *args.p <= 1.0;
+        else if (flag == "-g") valid = parseNumber(value, args.generator, 2) && args.generator > 1;
+        else if (flag == "--max-n") valid = parseNumber(value, args.maxN) && args.maxN <= 65;
+        else if (flag == "--max-k") valid = parseNumber(value, args.maxK) && args.maxK <= 64;
+        else if (flag == "--repetitions") valid = parseNumber(value, args.repetitions);
+        else if (flag == "--workers") valid = parseNumber(value, args.workerCount) && args.workerCount > 0;
+        else if (flag == "--memory") {
+            size_t mebibytes = 0;
+            valid = parseNumber(value, mebibytes) && mebibytes <= (SIZE_MAX >> 20);
+            args.memoryLimit = mebibytes << 20;
+        }
+        else if (flag == "--log") args.logPath = value;
+        else if (flag == "--rates") valid = parseErrorRates(value, args.errorRates);
+        else if (flag == "--vectors") valid = parseNumber(value, args.vecCount.emplace()) && *args.vecCount > 0;
+        else if (flag == "--samples") valid = parseNumber(value, args.sampleCount.emplace()) && *args.sampleCount > 0;
+        else if (flag == "--seed") valid = parseNumber(value, args.seed);
+        else if (flag == "--codes-per-k") valid = parseNumber(value, args.codesPerK) && args.codesPerK > 0;
+        else {
+            std::print(stderr, "Klaida! Nezinomas parametras '{}'.\n", flag);
+            return false;
+        }
+        if (!valid) {
+            std::print(stderr, "Klaida! Netinkama '{}' reiksme '{}'.\n", flag, value);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks that -n and -k describe a code whose syndrome table can be built.
+static bool validCode(const BenchmarkArgs& args) {
+    if (args.n < 2 || args.n > 64 || args.k < 1 || args.k >= args.n || args.n - args.k > maxSyndromeBits) {
+        std::print(stderr, "Klaida! Reikia nurodyti -n [2;64] ir -k [1;n-1], n-k ne daugiau {}.\n", maxSyndromeBits);
+        return false;
+    }
+    return true;
+}
+
+// Checks that -p is given.
+static bool validErrorRate(const BenchmarkArgs& args) {
+    if (!args.p) std::print(stderr, "Klaida! Reikia nurodyti klaidos tikimybe -p [0;1].\n");
+    return args.p.has_value();
+}
+
+int runBenchmark(int argc, char** argv) {
+    std::string_view name = argc >= 3 ? argv[2] : "";
+    BenchmarkArgs args;
+    if (!parseBenchmarkArgs(argc, argv, args)) return 1;
+
+    if (name == "sweep" || name == "sharded") {
+        if (args.maxN < 3 || args.maxN - 2 > maxSyndromeBits || args.maxK < 2) {
+            std::print(stderr, "Klaida! Reikia nurodyti --max-n [3;{}] ir --max-k [2;64].\n", maxSyndromeBits + 2);
+            return 1;
+        }
+        if (name == "sweep") {
+            benchmark(args.errorRates, args.maxN, args.maxK, args.repetitions, args.logPath, args.readCounters);
+            return 0;
+        }
+#ifdef __linux__
+        benchmarkSharded(args.errorRates, args.maxN, args.maxK, args.repetitions, args.workerCount, args.memoryLimit, args.logPath, args.readCounters);
+        return 0;
+#else
+        std::print(stderr, "Klaida! Paskirstytas matavimas veikia tik Linux sistemoje.\n");
+        return 1;
+#endif
+    }
+    if (name == "single" || name == "coupled" || name == "stratified") {
+        if (!validCode(args)) return 1;
+        if (name == "single") runSingleNK(args.errorRates, args.n, args.k, Channel(args.seed), args.readCounters);
+        else if (name == "coupled") runSingleNKCoupled(args.errorRates, args.n, args.k, Channel(args.seed));
+        else benchmarkImportanceSampling(args.errorRates, args.n, args.k, args.sampleCount.value_or(125'000), args.seed);
+        return 0;
+    }
+    if (name == "compare") {
+        if (args.n < 2 || args.n > 64 || args.maxK < 2 || args.n - 1 > maxSyndromeBits) {
+            std::print(stderr, "Klaida! Reikia nurodyti -n [2;{}] ir --max-k [2;64].\n", maxSyndromeBits + 1);
+            return 1;
+        }
+        compareCodes(args.errorRates, args.n, args.maxK, args.codesPerK, args.vecCount.value_or(20'000), args.seed);
+        return 0;
+    }
+    if (name == "batch" || name == "layout" || name == "ml") {
+        if (!validCode(args) || !validErrorRate(args)) return 1;
+        if (name == "batch") args.vecCount ? benchmarkBatchDecode(args.n, args.k, *args.p, *args.vecCount) : benchmarkBatchDecode(args.n, args.k, *args.p);
+        else if (name == "layout") args.vecCount ? benchmarkSyndromeLayout(args.n, args.k, *args.p, *args.vecCount) : benchmarkSyndromeLayout(args.n, args.k, *args.p);
+        else args.vecCount ? benchmarkMlDecode(args.n, args.k, *args.p, *args.vecCount) : benchmarkMlDecode(args.n, args.k, *args.p);
+        return 0;
+    }
+    if (name == "cyclic") {
+        size_t degree = std::bit_width(args.generator) - 1;
+        if (args.n < 2 || args.n > 64 || args.generator <= 1 || degree >= args.n) {
+            std::print(stderr, "Klaida! Reikia nurodyti -n [2;64] ir -g polinomo koeficientus nuo x^(n-k) iki x^0, 1 <= n-k < n.\n");
+            return 1;
+        }
+        args.vecCount ? benchmarkCyclic(args.n, args.generator, *args.vecCount) : benchmarkCyclic(args.n, args.generator);
+        return 0;
+    }
+    std::print(stderr, "Klaida! Nezinomas matavimas '{}'. Galimi: sweep, sharded, single, coupled, stratified, compare, batch, layout, ml, cyclic.\n", name);
+    return 1;
+}
@@ -1,113 +1,159 @@
 #pragma once
 
-#include <print>
 #include <vector>
-#include <algorithm>
-#include <unordered_map>
-#include <chrono>
-#include <fstream>
-#include <iterator>
-#include <format>
+#include <string>
+#include <string_view>
 
 #include "math.h"
-#include "encoder.h"
 #include "channel.h"
+#include "batchDecoder.h"
+#include "perfCounters.h"
+
+// Benchmarks are run from command line (see runBenchmark), e.g.
+//   program benchmark batch -n 24 -k 8 -p 0.05
+//
+// Subcommands:
+//   sweep      [--max-n N] [--max-k K] [--repetitions R] [--log FILE] [--rates P,P,...] [--counters]   see benchmark
+//   sharded    same as sweep, plus [--workers W] [--memory MIB]                          see benchmarkSharded (Linux only)
+//   single     -n N -k K [--counters] [--rates P,P,...]                                  see runSingleNK
+//   coupled    -n N -k K [--rates P,P,...]                                               see runSingleNKCoupled
+//   stratified -n N -k K [--samples S] [--seed S] [--rates P,P,...]                      see benchmarkImportanceSampling
+//   compare    -n N --max-k K [--codes-per-k C] [--vectors V] [--seed S] [--rates P,P,...]   see compareCodes
+//   batch      -n N -k K -p P [--vectors V]                                              see benchmarkBatchDecode
+//   layout     -n N -k K -p P [--vectors V]                                              see benchmarkSyndromeLayout
+//   ml         -n N -k K -p P [--vectors V]                                              see benchmarkMlDecode
+//   cyclic     -n N -g BITS [--vectors V]                                                see benchmarkCyclic
+// Error rates default to the ones of the stats in README.
+
+// Default sweep log, relative to working directory.
+constexpr std::string_view defaultSweepLogPath = "results.csv";
 
 struct batch {
     std::vector<double> successfulDecodeRates = {};
     double syndromeGenTimeMs = -1;
     double testRunTimeMs = -1;
     int64_t totalVecCount = -1;
+    PerfCounterValues syndromeGenCounters = {}; // empty if counters were not read
+    PerfCounterValues decodeCounters = {};
+};
+
+// Decode failure rate estimated for one error rate.
+struct FailureEstimate {
+    double p;
+    double rate; // probability that decoded message differs from sent one
+    double standardError;
 };
 
 // Runs a single test for given N and K values.
-// Only used manually for benchmarking.
-// Left here for reference.
-batch runSingleNK(const std::vector<double>& errorRates, size_t n, size_t k, Channel c) {
-    batch result{};
-    size_t inputMatRows = k;
-    size_t inputMatCols = n - k;
-    matrix g = matrix(k, k, true).append(randomMatrix(inputMatRows, inputMatCols));
-    matrix gTransposed = g.transpose();
-    matrix h = calculateControlMatrix(g);
-
-    std::print("N: {}, K: {}\n", n, k);
-    std::print("  Generating syndromes... ");
-    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-    Syndromes syndromes = calculateSyndromes(h);
-    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-    result.syndromeGenTimeMs = std::chrono::duration<double, std::milli>(end - begin).count();
-    std::print("Syndromes generated ({}ms)\n", result.syndromeGenTimeMs);
-
-    size_t vecCount = 125'000;
-    size_t totalVecCount = vecCount * errorRates.size();
-    result.totalVecCount = totalVecCount;
-    begin = std::chrono::steady_clock::now();
-    for (double p : errorRates) {
-        size_t errors = 0;
-        for (size_t i = 0; i < vecCount; i++) {
-            vec original = std::rand() % (1ULL << k);
-            vec r = encode(original, gTransposed);
-            r = c.sendVector(r, n, p);
-            vec out = decode(r, syndromes, h);
-            if (original != out) errors++;
-        }
-
-        double errRate = static_cast<double>(errors) / vecCount;
-        result.successfulDecodeRates.push_back((1.0 - errRate) * 100.0);
-    }
-    end = std::chrono::steady_clock::now();
-    result.testRunTimeMs = std::chrono::duration<double, std::milli>(end - begin).count();
-    std::print("  Tests ran ({}ms)\n", result.testRunTimeMs);
-    return result;
-}
+// If readCounters is set, hardware counters are read around syndrome generation and decoding,
+// and printed per operation next to timings (if this system has them).
+batch runSingleNK(const std::vector<double>& errorRates, size_t n, size_t k, Channel c, bool readCounters = false);
+
+// Same as runSingleNK, but all error rates are simulated in a single pass.
+// Every vector is generated and encoded once, and one random number per bit gives errors for every error rate
+// (see Channel::errorVectors). Error rates are processed in increasing order, and if error vector did not change
+// since the previous rate, previous decode result is reused.
+batch runSingleNKCoupled(const std::vector<double>& errorRates, size_t n, size_t k, Channel c);
+
+// Probability that a binary symmetric channel flips exactly w of n bits.
+// Computed in log space, so it stays accurate for very small p and large n.
+double binomialProbability(size_t n, size_t w, double p);
+
+// Estimates decode failure rates by stratifying error vectors by weight.
+// Failure of a linear code depends only on the error vector, so the zero codeword is sent and
+// P(failure) = sum over w of P(weight = w) * f_w, where P(weight = w) is the exact binomial probability
+// and f_w is the fraction of weight w error vectors that decode wrongly. f_w does not depend on p,
+// so one set of samples serves every error rate, however small. Weights with few error vectors are
+// enumerated exhaustively (f_w exact), the rest get random samples, more for weights that matter more
+// for the given error rates, at least one each. Estimates are unbiased, and unlike plain Monte Carlo
+// their relative error does not blow up as p gets small.
+// args:
+//   errorRates - error probabilities to estimate failure rates for.
+//   h - control matrix the table is indexed by.
+//   table - dense syndrome table.
+//   sampleCount - total number of error vectors to decode.
+//   seed - seed of random error vectors.
+// returns:
+//   std::vector<FailureEstimate> - estimate for every error rate, in the same order.
+std::vector<FailureEstimate> estimateFailureRatesStratified(const std::vector<double>& errorRates, const matrix& h,
+                                                            const SyndromeTable& table, size_t sampleCount, uint64_t seed = 0);
+
+// Compares stratified failure rate estimates with plain Monte Carlo using the same number of decoded vectors.
+// For every error rate prints both estimates with standard errors, and how many vectors plain Monte Carlo
+// would need to reach the standard error of the stratified estimate.
+void benchmarkImportanceSampling(const std::vector<double>& errorRates, size_t n, size_t k,
+                                 size_t sampleCount = 125'000, uint64_t seed = 0);
 
 // Runs benchmarks and writes results to a file.
-// Only used manually for benchmarking.
-// Left here for reference.
-void benchmark(const std::vector<double>& errorRates, size_t maxN, size_t maxK) {
-    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-    std::vector<std::unordered_map<vec, std::unordered_map<vec, batch>>> results;
-    results.resize(2);
-    Channel c;
-    for (auto& res : results) {
-        for (size_t n = 2; n < maxN; n++) {
-            for (size_t k = 1; k <= n && k < maxK; k++) {
-                res[n][k] = runSingleNK(errorRates, n, k, c);
-            }
-        }
-    }
-    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-    std::print("Benchmark finished in {}ms\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
-
-    std::ofstream file("results.txt");
-    std::ostream_iterator<char> fileOut(file);
-
-    std::format_to(fileOut, "ERROR_RATES=");
-    for (double p : errorRates) {
-        std::format_to(fileOut, "{}{}", p, p == errorRates.back() ? "\n" : " ");
-    }
-    std::format_to(fileOut, " N | K | VEC_COUNT | SYNDROME_GEN_TIME_MS | TEST_RUN_TIME_MS | DECODE_RATES\n");
-    for (size_t n = 2; n < maxN; n++) {
-        for (size_t k = 1; k <= n && k < maxK; k++) {
-            batch b = results[0][n][k];
-            for (size_t i = 1; i < results.size(); i++) {
-                for (size_t j = 0; j < results[i][n][k].successfulDecodeRates.size(); j++) {
-                    b.successfulDecodeRates[j] += results[i][n][k].successfulDecodeRates[j];
-                }
-                b.syndromeGenTimeMs += results[i][n][k].syndromeGenTimeMs;
-                b.testRunTimeMs += results[i][n][k].testRunTimeMs;
-            }
-            for (double& rate : b.successfulDecodeRates) {
-                rate /= results.size();
-            }
-            b.syndromeGenTimeMs /= results.size();
-            b.testRunTimeMs /= results.size();
-
-            std::format_to(fileOut, "{} {} {} {:f} {:f} ", n, k, b.totalVecCount, b.syndromeGenTimeMs, b.testRunTimeMs);
-            for (size_t i = 0; i < b.successfulDecodeRates.size(); i++) {
-                std::format_to(fileOut, "{:f}{}", b.successfulDecodeRates[i], i == b.successfulDecodeRates.size() - 1 ? "\n" : " ");
-            }
-        }
-    }
-}
\ No newline at end of file
+// Every finished (n, k, p, seed) point is appended to a sweep log right away. Points already in the log are skipped,
+// so an interrupted sweep can be continued, and a bigger sweep only computes new points.
+// Same seed always gives the same G matrix, messages and channel errors.
+// Averages of every (n, k) cell are written to results.txt.
+// If readCounters is set, hardware counters are read around decoding of every point and are written to the log
+// and, per decoded vector, to results.txt (left empty if this system doesn't have them).
+// args:
+//   errorRates - error probabilities of every cell.
+//   maxN, maxK - cells have 2 <= n < maxN and 1 <= k < maxK.
+//   repetitions - number of seeds of every cell.
+//   logPath - path of sweep log.
+//   readCounters - read hardware counters around decoding.
+void benchmark(const std::vector<double>& errorRates, size_t maxN, size_t maxK, size_t repetitions = 2,
+               const std::string& logPath = std::string(defaultSweepLogPath), bool readCounters = false);
+
+#ifdef __linux__
+// Runs the same sweep as benchmark, with the same results, but in several worker processes.
+// Coordinator puts every (n, k, seed) cell with unfinished points into a work queue in shared memory
+// and forks workers, which take cells from the queue and add error counts to shared results with atomics.
+// If a worker dies (crash, kill, memory limit), partial results of its cell are dropped, the cell is put back
+// into the queue and a new worker is started. Only coordinator writes finished cells to sweep log, so
+// an interrupted sweep can be continued the same way as with benchmark.
+// args:
+//   errorRates, maxN, maxK, repetitions, logPath, readCounters - same as benchmark.
+//   workerCount - number of worker processes.
+//   memoryLimit - address space limit of every worker in bytes, 0 for no limit.
+void benchmarkSharded(const std::vector<double>& errorRates, size_t maxN, size_t maxK, size_t repetitions = 2,
+                      size_t workerCount = 4, size_t memoryLimit = 0, const std::string& logPath = std::string(defaultSweepLogPath),
+                      bool readCounters = false);
+#endif
+
+// Measures throughput of batch decoding with every instruction set supported by this CPU.
+// Checks that results are identical to decode.
+void benchmarkBatchDecode(size_t n, size_t k, double p, size_t vecCount = 1'000'000);
+
+// Compares batch decoding with plain syndrome table and with table reordered for cache locality
+// (localizeSyndromeTable), with every instruction set: throughput and hardware counters (cache misses) per vector.
+// Checks that both layouts give identical results. Differences show up when the table doesn't fit into cache (n-k >= 20).
+void benchmarkSyndromeLayout(size_t n, size_t k, double p, size_t vecCount = 1'000'000);
+
+// Compares maximum likelihood decoding with every instruction set against decode and batch decoding:
+// throughput and how many vectors were decoded to a wrong message. Checks that all instruction sets
+// of maximum likelihood decoding give identical results.
+void benchmarkMlDecode(size_t n, size_t k, double p, size_t vecCount = 200'000);
+
+// Compares codes of the same length n using common random numbers: one stream of messages and channel errors
+// is generated for every error rate and fed to every candidate code, so differences between codes are not hidden
+// by differences in noise. For every pair of neighboring candidates, prints the paired difference of decode
+// failure rates with a 95% confidence interval, and how many times fewer vectors the pairing needs
+// compared to independent streams for the same interval.
+// Decode failure of a linear code depends only on the error vector, so the noise is what's shared.
+// args:
+//   errorRates - error probabilities to test.
+//   n - code length.
+//   maxK - candidates have k = 1 .. maxK-1.
+//   codesPerK - number of random codes tried for every k.
+//   vecCount - number of vectors for every error rate.
+//   seed - seed of codes, messages and errors.
+void compareCodes(const std::vector<double>& errorRates, size_t n, size_t maxK, size_t codesPerK = 1,
+                  size_t vecCount = 20'000, uint64_t seed = 0);
+
+// Compares encoding and syndrome computation of a cyclic code done with polynomial remainders
+// against the same code used through its matrices.
+void benchmarkCyclic(size_t n, vec generator, size_t vecCount = 10'000'000);
+
+// Runs benchmark subcommand.
+// args:
+//   argc - number of command line arguments.
+//   argv - command line arguments, argv[1] is "benchmark" and argv[2] is the subcommand.
+// returns:
+//   int - exit code: 0 on success, 1 if arguments are invalid.
+int runBenchmark(int argc, char** argv);
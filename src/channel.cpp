@@ -2,10 +2,15 @@
 
 #include <random>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
 
 Channel::Channel()
     :   m_generator(std::chrono::system_clock::now().time_since_epoch().count()),
         m_distribution(0.0, 1.0) {}
+Channel::Channel(uint64_t seed)
+    :   m_generator(seed),
+        m_distribution(0.0, 1.0) {}
 
 vec Channel::sendVector(vec input, size_t vecSize, double p) {
     for (size_t i = 0; i < vecSize; i++) {
@@ -13,3 +18,33 @@ vec Channel::sendVector(vec input, size_t vecSize, double p) {
     }
     return input;
 }
+
+void Channel::errorVectors(size_t vecSize, std::span<const double> p, std::span<vec> errors) {
+    std::fill(errors.begin(), errors.end(), 0);
+    for (size_t i = 0; i < vecSize; i++) {
+        double u = m_distribution(m_generator);
+        // p is sorted, so once u is below p, it is below every following p
+        size_t first = std::upper_bound(p.begin(), p.end(), u) - p.begin();
+        for (size_t j = first; j < p.size(); j++) {
+            errors[j] |= vec{1} << i;
+        }
+    }
+}
+void Channel::sendBytes(std::span<uint8_t> data, double p) {
+    if (p <= 0.0) return;
+    if (p >= 1.0) {
+        for (auto& byte : data) byte = ~byte;
+        return;
+    }
+    // number of correct bits before next error is floor(log(u) / log(1-p)), u in (0;1]
+    double logCorrect = std::log1p(-p);
+    size_t bitCount = data.size() * 8;
+    size_t bit = 0;
+    while (true) {
+        double skip = std::floor(std::log(1.0 - m_distribution(m_generator)) / logCorrect);
+        if (skip >= static_cast<double>(bitCount - bit)) break;
+        bit += static_cast<size_t>(skip);
+        data[bit / 8] ^= static_cast<uint8_t>(0x80 >> (bit % 8));
+        bit++;
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <random>
+#include <span>
 
 #include "math.h"
 
@@ -9,6 +10,11 @@ public:
     // Constructs a channel with default a random seed.
     Channel();
 
+    // Constructs a channel with given seed. Same seed always gives the same errors.
+    // args:
+    //   seed - seed of random generator.
+    explicit Channel(uint64_t seed);
+
     // Sends a vector through the channel and flips bits with probability p.
     // args:
     //   input - vector to send.
@@ -16,7 +22,24 @@ public:
     //   p - probability of errors.
     // returns:
     //   vec - received vector.
-    vec sendVector(vec input, size_t vecSize, double p);\
+    vec sendVector(vec input, size_t vecSize, double p);
+
+    // Generates error vectors for several error probabilities at once, drawing one random number per bit.
+    // Bit is flipped for probability p if its number is below p, so errors for smaller p
+    // are always a subset of errors for bigger p.
+    // args:
+    //   vecSize - size of vector in bits.
+    //   p - probabilities of errors, sorted in increasing order.
+    //   errors - gets set to error vector for every probability. Must have the same size as p.
+    void errorVectors(size_t vecSize, std::span<const double> p, std::span<vec> errors);
+
+    // Sends bytes through the channel in place and flips every bit with probability p.
+    // Instead of drawing a random number for every bit, distance to the next flipped bit is drawn
+    // (geometric distribution), so time depends on number of errors, not on number of bits.
+    // args:
+    //   data - bytes to send, get replaced with received bytes.
+    //   p - probability of errors.
+    void sendBytes(std::span<uint8_t> data, double p);
 
 private:
     std::default_random_engine m_generator;
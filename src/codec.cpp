@@ -0,0 +1,168 @@
+#include "codec.h"
+
+#include <new>
+#include <cstdio>
+#include <cstring>
+#include <span>
+
+#include "math.h"
+#include "encoder.h"
+#include "batchDecoder.h"
+
+struct CodecCode {
+    size_t n, k;
+    matrix gTransposed, h;
+    matrix tableH; // control matrix whose syndromes index table (see localizeSyndromeTable)
+    SyndromeTable table; // reordered for cache locality, empty until built or loaded
+};
+
+// Syndrome table file: header followed by 2^(n-k) weights.
+// Version 1 files have weights in syndrome order, version 2 files are reordered like the table in memory.
+struct SyndromeFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t n, k;
+    uint64_t codeHash; // hash of control matrix, so table of other code with same n, k is rejected
+};
+
+constexpr char syndromeFileMagic[4] = { 'K', 'S', 'Y', 'N' };
+constexpr uint32_t syndromeFileVersion = 2;
+
+// FNV-1a hash of control matrix rows.
+static uint64_t controlMatrixHash(const matrix& h) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t r = 0; r < h.rows(); r++) {
+        for (size_t i = 0; i < sizeof(vec); i++) {
+            hash ^= (h.data()[r] >> (i * 8)) & 0xFF;
+            hash *= 0x100000001B3ULL;
+        }
+    }
+    return hash;
+}
+
+static vec bitMask(size_t bits) {
+    return bits == 64 ? ~vec{0} : (vec{1} << bits) - 1;
+}
+
+const char* codecStatusString(CodecStatus status) {
+    switch (status) {
+    case CODEC_OK: return "ok";
+    case CODEC_INVALID_ARGUMENT: return "invalid argument";
+    case CODEC_NO_SYNDROMES: return "syndrome table is not built or loaded";
+    case CODEC_IO_ERROR: return "file input/output error";
+    case CODEC_BAD_FILE: return "file is not a syndrome table of this code";
+    case CODEC_OUT_OF_MEMORY: return "out of memory";
+    default: return "unknown status";
+    }
+}
+
+CodecStatus codecCreate(uint32_t n, uint32_t k, const uint64_t* a, CodecCode** code) {
+    if (a == nullptr || code == nullptr || n < 2 || n > 64 || k < 1 || k >= n || n - k > maxSyndromeBits) {
+        return CODEC_INVALID_ARGUMENT;
+    }
+    try {
+        matrix partA(k, n - k);
+        for (size_t r = 0; r < k; r++) {
+            if (a[r] & ~bitMask(n - k)) return CODEC_INVALID_ARGUMENT;
+            partA.data()[r] = a[r];
+        }
+        matrix g = matrix(k, k, true).append(partA);
+        matrix h = calculateControlMatrix(g);
+        *code = new CodecCode{ n, k, g.transpose(), h, localSyndromeControlMatrix(h), {} };
+        return CODEC_OK;
+    } catch (const std::bad_alloc&) {
+        return CODEC_OUT_OF_MEMORY;
+    }
+}
+
+void codecDestroy(CodecCode* code) {
+    delete code;
+}
+
+uint32_t codecN(const CodecCode* code) {
+    return code ? static_cast<uint32_t>(code->n) : 0;
+}
+
+uint32_t codecK(const CodecCode* code) {
+    return code ? static_cast<uint32_t>(code->k) : 0;
+}
+
+CodecStatus codecBuildSyndromes(CodecCode* code) {
+    if (code == nullptr) return CODEC_INVALID_ARGUMENT;
+    try {
+        code->table = makeLocalSyndromeTable(calculateSyndromes(code->h), code->h).table;
+        return CODEC_OK;
+    } catch (const std::bad_alloc&) {
+        return CODEC_OUT_OF_MEMORY;
+    }
+}
+
+CodecStatus codecSaveSyndromes(const CodecCode* code, const char* path) {
+    if (code == nullptr || path == nullptr) return CODEC_INVALID_ARGUMENT;
+    if (code->table.empty()) return CODEC_NO_SYNDROMES;
+
+    SyndromeFileHeader header{};
+    std::memcpy(header.magic, syndromeFileMagic, sizeof(header.magic));
+    header.version = syndromeFileVersion;
+    header.n = static_cast<uint32_t>(code->n);
+    header.k = static_cast<uint32_t>(code->k);
+    header.codeHash = controlMatrixHash(code->h);
+
+    FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) return CODEC_IO_ERROR;
+    size_t size = size_t{1} << (code->n - code->k);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 && std::fwrite(code->table.data(), 1, size, file) == size;
+    ok = std::fclose(file) == 0 && ok;
+    return ok ? CODEC_OK : CODEC_IO_ERROR;
+}
+
+CodecStatus codecLoadSyndromes(CodecCode* code, const char* path) {
+    if (code == nullptr || path == nullptr) return CODEC_INVALID_ARGUMENT;
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) return CODEC_IO_ERROR;
+
+    SyndromeFileHeader header{};
+    CodecStatus status = CODEC_OK;
+    if (std::fread(&header, sizeof(header), 1, file) != 1) {
+        status = CODEC_BAD_FILE;
+    } else if (std::memcmp(header.magic, syndromeFileMagic, sizeof(header.magic)) != 0 || header.version < 1 || header.version > syndromeFileVersion ||
+               header.n != code->n || header.k != code->k || header.codeHash != controlMatrixHash(code->h)) {
+        status = CODEC_BAD_FILE;
+    } else {
+        try {
+            // table is built with padding, then weights are read over it
+            SyndromeTable table = makeSyndromeTable({}, code->n - code->k);
+            size_t size = size_t{1} << (code->n - code->k);
+            if (std::fread(table.data(), 1, size, file) != size) status = CODEC_BAD_FILE;
+            else if (header.version == 1) code->table = localizeSyndromeTable(table, code->h).table;
+            else code->table = std::move(table);
+        } catch (const std::bad_alloc&) {
+            status = CODEC_OUT_OF_MEMORY;
+        }
+    }
+    std::fclose(file);
+    return status;
+}
+
+CodecStatus codecEncode(const CodecCode* code, const uint64_t* messages, uint64_t* codewords, size_t count) {
+    if (code == nullptr || (count != 0 && (messages == nullptr || codewords == nullptr))) return CODEC_INVALID_ARGUMENT;
+    vec mask = bitMask(code->k);
+    for (size_t i = 0; i < count; i++) {
+        if (messages[i] & ~mask) return CODEC_INVALID_ARGUMENT;
+    }
+    for (size_t i = 0; i < count; i++) {
+        codewords[i] = encode(messages[i], code->gTransposed);
+    }
+    return CODEC_OK;
+}
+
+CodecStatus codecDecode(const CodecCode* code, const uint64_t* received, uint64_t* messages, size_t count) {
+    if (code == nullptr || (count != 0 && (received == nullptr || messages == nullptr))) return CODEC_INVALID_ARGUMENT;
+    if (code->table.empty()) return CODEC_NO_SYNDROMES;
+    vec mask = bitMask(code->n);
+    for (size_t i = 0; i < count; i++) {
+        if (received[i] & ~mask) return CODEC_INVALID_ARGUMENT;
+    }
+    decodeBatch(std::span<const vec>(received, count), std::span<vec>(messages, count), code->table, code->tableH);
+    return CODEC_OK;
+}
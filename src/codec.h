@@ -0,0 +1,104 @@
+#pragma once
+
+// C interface of the linear code library (libcodec.a / libcodec.so), for linking the codec into other programs.
+// Vectors are passed as 64-bit words with the first bit of the vector in the highest used bit
+// (bit n-1 for codewords, bit k-1 for messages), same as everywhere in this program.
+// Encoding and decoding work directly on caller buffers and don't allocate.
+// Functions that take a const code can be called from several threads at once.
+// The library is written in C++, so static linking also needs the C++ standard library (e.g. -lstdc++).
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Code with its generator matrix, control matrix and syndrome table. Contents are private.
+typedef struct CodecCode CodecCode;
+
+// Result of every function that can fail.
+typedef enum CodecStatus {
+    CODEC_OK = 0,
+    CODEC_INVALID_ARGUMENT = 1, // null pointer, bad n/k, or vector with bits above n (or k)
+    CODEC_NO_SYNDROMES = 2, // decoding needs syndrome table, build or load it first
+    CODEC_IO_ERROR = 3, // file could not be opened, read or written
+    CODEC_BAD_FILE = 4, // file is not a syndrome table of this code
+    CODEC_OUT_OF_MEMORY = 5,
+} CodecStatus;
+
+// Returns description of status.
+// args:
+//   status - status to describe.
+// returns:
+//   const char* - static string, e.g. "ok".
+const char* codecStatusString(CodecStatus status);
+
+// Creates code with generator matrix G = [I | A].
+// args:
+//   n - code length, 2..64.
+//   k - code dimension, 1..n-1. n-k must be at most 32 (syndrome table has 2^(n-k) bytes).
+//   a - k rows of A, each n-k bits.
+//   code - gets set to created code. Must be destroyed with codecDestroy.
+// returns:
+//   CodecStatus - CODEC_OK on success.
+CodecStatus codecCreate(uint32_t n, uint32_t k, const uint64_t* a, CodecCode** code);
+
+// Destroys code. Does nothing if code is null.
+// args:
+//   code - code to destroy.
+void codecDestroy(CodecCode* code);
+
+// Returns code length n.
+uint32_t codecN(const CodecCode* code);
+
+// Returns code dimension k.
+uint32_t codecK(const CodecCode* code);
+
+// Builds syndrome table of code. Takes time and memory exponential in n-k.
+// args:
+//   code - code to build table for.
+// returns:
+//   CodecStatus - CODEC_OK on success.
+CodecStatus codecBuildSyndromes(CodecCode* code);
+
+// Saves syndrome table to file, so later runs can load it instead of building it.
+// args:
+//   code - code with built or loaded syndrome table.
+//   path - file to write.
+// returns:
+//   CodecStatus - CODEC_OK on success.
+CodecStatus codecSaveSyndromes(const CodecCode* code, const char* path);
+
+// Loads syndrome table saved by codecSaveSyndromes. File must have been saved for the same code.
+// Files of older versions of the library are accepted too.
+// args:
+//   code - code to load table for.
+//   path - file to read.
+// returns:
+//   CodecStatus - CODEC_OK on success.
+CodecStatus codecLoadSyndromes(CodecCode* code, const char* path);
+
+// Encodes messages.
+// args:
+//   code - code to encode with.
+//   messages - count messages of k bits.
+//   codewords - gets count codewords of n bits. Can be the same buffer as messages.
+//   count - number of vectors.
+// returns:
+//   CodecStatus - CODEC_OK on success.
+CodecStatus codecEncode(const CodecCode* code, const uint64_t* messages, uint64_t* codewords, size_t count);
+
+// Decodes received vectors, with SIMD batch decoding if CPU supports it.
+// args:
+//   code - code with built or loaded syndrome table.
+//   received - count vectors of n bits.
+//   messages - gets count decoded messages of k bits. Can be the same buffer as received.
+//   count - number of vectors.
+// returns:
+//   CodecStatus - CODEC_OK on success.
+CodecStatus codecDecode(const CodecCode* code, const uint64_t* received, uint64_t* messages, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,95 @@
+#include "cyclic.h"
+
+#include <bit>
+#include <assert.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define CYCLIC_X86
+#endif
+
+// Result of carry-less multiplication of two 64-bit polynomials.
+struct ClmulResult {
+    vec low, high;
+};
+
+// Portable carry-less multiplication, one shifted xor per set bit of b.
+static ClmulResult clmulSoftware(vec a, vec b) {
+    ClmulResult result{ 0, 0 };
+    while (b != 0) {
+        int i = std::countr_zero(b);
+        result.low ^= a << i;
+        if (i != 0) result.high ^= a >> (64 - i);
+        b &= b - 1;
+    }
+    return result;
+}
+
+#ifdef CYCLIC_X86
+__attribute__((target("pclmul,sse4.1")))
+static ClmulResult clmulHardware(vec a, vec b) {
+    __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(a), _mm_cvtsi64_si128(b), 0x00);
+    return { static_cast<vec>(_mm_cvtsi128_si64(product)), static_cast<vec>(_mm_extract_epi64(product, 1)) };
+}
+#endif
+
+CyclicCode::CyclicCode(size_t n, vec generator)
+    :   m_n(n),
+        m_degree(63 - std::countl_zero(generator)),
+        m_generator(generator),
+        m_mu(0),
+        m_hardwareClmul(false) {
+    assert(generator > 1);
+    assert(m_degree < n);
+    assert(n <= 64);
+
+    // long division of x^64 by g(x). Remainder starts as x^64, which doesn't fit, so first step is done separately:
+    // x^64 - g(x) * x^(64-degree) = (g(x) without leading term) * x^(64-degree)
+    vec leadless = generator ^ (vec{1} << m_degree);
+    m_mu = vec{1} << (64 - m_degree);
+    vec rem = leadless << (64 - m_degree);
+    for (size_t bit = 63; bit >= m_degree; bit--) {
+        if ((rem >> bit) & 1) {
+            m_mu |= vec{1} << (bit - m_degree);
+            rem ^= generator << (bit - m_degree);
+        }
+    }
+
+#ifdef CYCLIC_X86
+    m_hardwareClmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+vec CyclicCode::remainder(vec a) const {
+    // Barrett reduction: quotient is floor(floor(a / x^degree) * mu / x^(64-degree)),
+    // which is exact for polynomials of degree < 64
+    vec high = a >> m_degree;
+    ClmulResult t;
+    ClmulResult qg;
+#ifdef CYCLIC_X86
+    if (m_hardwareClmul) {
+        t = clmulHardware(high, m_mu);
+        vec q = (t.low >> (64 - m_degree)) | (t.high << m_degree);
+        qg = clmulHardware(q, m_generator);
+        return (a ^ qg.low) & ((vec{1} << m_degree) - 1);
+    }
+#endif
+    t = clmulSoftware(high, m_mu);
+    vec q = (t.low >> (64 - m_degree)) | (t.high << m_degree);
+    qg = clmulSoftware(q, m_generator);
+    return (a ^ qg.low) & ((vec{1} << m_degree) - 1);
+}
+
+matrix CyclicCode::generatorMatrixA() const {
+    matrix a(k(), m_degree);
+    for (size_t i = 0; i < k(); i++) {
+        a.data()[i] = remainder(vec{1} << (m_n - 1 - i));
+    }
+    return a;
+}
+
+vec decode(vec input, const Syndromes& syndromes, const CyclicCode& code) {
+    return decodeStepByStep(input, code.n(), code.k(),
+                            [&](vec r) { return code.syndrome(r); },
+                            [&](vec syndrome) { return getSyndromeWeight(syndromes, syndrome); });
+}
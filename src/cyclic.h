@@ -0,0 +1,73 @@
+#pragma once
+
+#include "math.h"
+#include "encoder.h"
+
+// Code given by generator polynomial g(x) (cyclic code if g(x) divides x^n + 1, e.g. BCH, otherwise shortened/CRC-like).
+// Polynomials are stored in vec with bit i holding coefficient of x^i.
+// Encoding is systematic: c(x) = m(x) * x^(n-k) + (m(x) * x^(n-k) mod g(x)), so message is in the first k bits,
+// same as with G = [I | A]. Syndrome is r(x) mod g(x), which is the same as H * r for H = [A^T | I],
+// so the code works with syndrome tables and decoders made from generatorMatrix().
+// Remainders are computed with carry-less multiplication and Barrett reduction (PCLMULQDQ if CPU has it),
+// so encoding and syndromes take constant time, without tables or per-bit loops.
+class CyclicCode {
+public:
+    // Constructs code from generator polynomial.
+    // args:
+    //   n - code length.
+    //   generator - generator polynomial, its degree (highest set bit) is n-k. Must be at least 1.
+    CyclicCode(size_t n, vec generator);
+
+    // Returns code length.
+    size_t n() const { return m_n; }
+
+    // Returns code dimension.
+    size_t k() const { return m_n - m_degree; }
+
+    // Returns generator polynomial.
+    vec generator() const { return m_generator; }
+
+    // Computes remainder of polynomial division by generator polynomial.
+    // args:
+    //   a - polynomial of degree less than 64.
+    // returns:
+    //   vec - a(x) mod g(x).
+    vec remainder(vec a) const;
+
+    // Encodes message.
+    // args:
+    //   input - message, k bits.
+    // returns:
+    //   vec - codeword, n bits.
+    vec encode(vec input) const { return (input << m_degree) | remainder(input << m_degree); }
+
+    // Computes syndrome of received vector. Equal to H * r for H of generatorMatrix().
+    // args:
+    //   input - received vector, n bits.
+    // returns:
+    //   vec - syndrome, n-k bits.
+    vec syndrome(vec input) const { return remainder(input); }
+
+    // Returns part A of systematic generator matrix G = [I | A] of this code.
+    // Row i is x^(n-1-i) mod g(x).
+    // returns:
+    //   matrix - part A of generator matrix (k rows, n-k cols).
+    matrix generatorMatrixA() const;
+
+private:
+    size_t m_n;
+    size_t m_degree; // n-k
+    vec m_generator;
+    vec m_mu; // floor(x^64 / g(x)), used for Barrett reduction
+    bool m_hardwareClmul;
+};
+
+// Decodes input vector using syndromes of cyclic code.
+// Same result as decode with control matrix of the code, but syndromes are computed as remainders.
+// args:
+//   input - vector to decode.
+//   syndromes - syndromes of the code.
+//   code - cyclic code.
+// returns:
+//   vec - decoded vector.
+vec decode(vec input, const Syndromes& syndromes, const CyclicCode& code);
@@ -1,6 +1,7 @@
 #include "encoder.h"
 
 #include <bit>
+#include <algorithm>
 
 matrix calculateControlMatrix(const matrix& g) {
     // calculate transposed A matrix
@@ -46,8 +47,17 @@ vec nextCombination(vec v) {
 }
 
 Syndromes calculateSyndromes(const matrix& h) {
+    return calculateSyndromes(h, {}, nullptr);
+}
+
+Syndromes calculateSyndromes(const matrix& h, std::stop_token stop, SyndromeProgress* progress) {
     size_t n = h.cols();
     size_t syndromeCount = 1ULL << h.rows(); // 2^(n-k)
+    SyndromeProgress unused;
+    if (progress == nullptr) progress = &unused;
+    progress->total = syndromeCount;
+    progress->found = 1;
+
     Syndromes syndromes;
     syndromes.reserve(syndromeCount);
     syndromes[0] = 100; // 0 always exists. For now set it to something so its not default value
@@ -61,9 +71,16 @@ Syndromes calculateSyndromes(const matrix& h) {
     size_t permutations = n;
     for (uint8_t i = 1; i <= n; i++) {
         vec v = (1 << i) - 1; // first combination
+        progress->weight = i;
 
         // iterate all combinations
         for (size_t j = 0; j < permutations; j++) {
+            // check for cancellation and report progress only once in a while, it is relatively slow
+            if (j % 4096 == 0) {
+                if (stop.stop_requested()) return syndromes;
+                progress->found.store(syndromes.size(), std::memory_order_relaxed);
+            }
+
             // compute syndrome
             vec syndrome = h.multVectorOnRight(v);
 
@@ -73,6 +90,7 @@ Syndromes calculateSyndromes(const matrix& h) {
                 weight = i;
                 if (syndromes.size() >= syndromeCount) {
                     syndromes[0] = 0; // set weight for 0
+                    progress->found = syndromes.size();
                     return syndromes; // all syndromes found
                 }
             }
@@ -86,6 +104,7 @@ Syndromes calculateSyndromes(const matrix& h) {
         permutations /= i + 1;
     }
 
+    progress->found = syndromes.size();
     return syndromes;
 }
 
@@ -93,13 +112,6 @@ vec encode(vec input, const matrix& gTransposed) {
     return gTransposed.multVectorOnRight(input);
 }
 
-// A helper function to get weight of syndrome. If syndrome is not in syndromes, returns 0.
-// Would be simpler to just index the hashmap, but that creates new entry if it doesn't exist, so can't be used with const.
-// args:
-//   syndromes - map of syndromes and their weights.
-//   syndrome - syndrome to get weight of.
-// returns:
-//   uint8_t - weight of syndrome.
 uint8_t getSyndromeWeight(const Syndromes& syndromes, vec syndrome) {
     auto it = syndromes.find(syndrome);
     if (it == syndromes.end()) return 0;
@@ -107,29 +119,85 @@ uint8_t getSyndromeWeight(const Syndromes& syndromes, vec syndrome) {
 }
 
 vec decode(vec input, const Syndromes& syndromes, const matrix& h) {
-    size_t n = h.cols();
-    size_t k = n - h.rows();
-    vec r = input;
-    // algorithm in the paper loops over N bits, but because we throw out last n-k bits, we can just not proccess them,
-    // because they don't affect previous bits, so we loop over K bits
-    for (size_t i = 0; i < k; i++) {
-        // compute H * r (syndrome)
-        vec rSyndrome = h.multVectorOnRight(r);
-        uint8_t rWeight = getSyndromeWeight(syndromes, rSyndrome);
-
-        // if weight is 0, error fixed
-        if (rWeight == 0) break;
-
-        // compute H * (r + e_i) (syndrome with bit flipped)
-        vec rFlipped = r ^ (1ULL << (n - i - 1));
-        vec rFlippedSyndrome = h.multVectorOnRight(rFlipped);
-        uint8_t rFlippedWeight = getSyndromeWeight(syndromes, rFlippedSyndrome);
-
-        // if flipped weight is smaller, set r to r + e_i
-        if (rFlippedWeight < rWeight) r = rFlipped;
+    return decodeStepByStep(input, h.cols(), h.cols() - h.rows(),
+                            [&](vec r) { return h.multVectorOnRight(r); },
+                            [&](vec syndrome) { return getSyndromeWeight(syndromes, syndrome); });
+}
+
+SyndromeOracle::SyndromeOracle(const matrix& h, uint8_t maxWeight, size_t capacity)
+    :   m_maxWeight(maxWeight),
+        m_shardCapacity(std::max<size_t>(capacity / shardCount, 1)),
+        m_shards(std::make_unique<CacheShard[]>(shardCount)) {
+    // column j of h is the syndrome of error vector with only bit j set
+    matrix hTransposed = h.transpose();
+    m_columns.assign(hTransposed.data().begin(), hTransposed.data().begin() + hTransposed.rows());
+    m_columnSet.insert(m_columns.begin(), m_columns.end());
+}
+
+// Checks if target is a sum of 'depth' columns, using only columns from 'start' onwards.
+// Last column is found with a lookup, so searching weight w costs C(n, w-1) lookups.
+// args:
+//   target - syndrome left to explain.
+//   start - first column that can be used.
+//   depth - number of columns to use.
+// returns:
+//   bool - true if target can be written as a sum of 'depth' columns.
+bool SyndromeOracle::searchColumns(vec target, size_t start, size_t depth) const {
+    if (depth == 1) return m_columnSet.contains(target);
+    for (size_t j = start; j + depth <= m_columns.size(); j++) {
+        if (searchColumns(target ^ m_columns[j], j + 1, depth - 1)) return true;
     }
+    return false;
+}
 
-    // throw out n-k bits
-    r >>= n - k;
-    return r;
+uint8_t SyndromeOracle::search(vec syndrome) const {
+    if (syndrome == 0) return 0;
+    // weights are checked in increasing order, so first match is the weight of coset leader.
+    // If a match reuses a column, target is a sum of less columns, which would have been found earlier.
+    for (uint8_t w = 1; w <= m_maxWeight && w <= m_columns.size(); w++) {
+        if (searchColumns(syndrome, 0, w)) return w;
+    }
+    return m_maxWeight + 1;
 }
+
+uint8_t SyndromeOracle::weight(vec syndrome) const {
+    CacheShard& shard = m_shards[std::hash<vec>{}(syndrome) % shardCount];
+    {
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.index.find(syndrome);
+        if (it != shard.index.end()) {
+            CacheEntry& entry = shard.entries[it->second];
+            entry.referenced = true;
+            return entry.weight;
+        }
+    }
+
+    // search without holding the lock, other threads can use the shard meanwhile
+    uint8_t weight = search(syndrome);
+
+    std::lock_guard lock(shard.mutex);
+    if (shard.index.contains(syndrome)) return weight; // another thread added it first
+    if (shard.entries.size() < m_shardCapacity) {
+        shard.index[syndrome] = shard.entries.size();
+        shard.entries.push_back({ syndrome, weight, false });
+        return weight;
+    }
+
+    // cache is full, evict first entry that was not used since last pass of the hand
+    while (shard.entries[shard.hand].referenced) {
+        shard.entries[shard.hand].referenced = false;
+        shard.hand = (shard.hand + 1) % shard.entries.size();
+    }
+    CacheEntry& victim = shard.entries[shard.hand];
+    shard.index.erase(victim.syndrome);
+    victim = { syndrome, weight, false };
+    shard.index[syndrome] = shard.hand;
+    shard.hand = (shard.hand + 1) % shard.entries.size();
+    return weight;
+}
+
+vec decode(vec input, const SyndromeOracle& oracle, const matrix& h) {
+    return decodeStepByStep(input, h.cols(), h.cols() - h.rows(),
+                            [&](vec r) { return h.multVectorOnRight(r); },
+                            [&](vec syndrome) { return oracle.weight(syndrome); });
+}
\ No newline at end of file
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stop_token>
 
 #include "math.h"
 
@@ -20,6 +26,73 @@ matrix calculateControlMatrix(const matrix& g);
 //   Syndromes - map of syndromes and their associated weight.
 Syndromes calculateSyndromes(const matrix& h);
 
+// Progress of syndrome calculation. Can be read from other threads while syndromes are calculated.
+struct SyndromeProgress {
+    std::atomic<size_t> found = 0; // number of syndromes found so far
+    std::atomic<size_t> total = 0; // number of syndromes that exist (2^(n-k))
+    std::atomic<uint8_t> weight = 0; // weight of error vectors currently checked
+};
+
+// Calculates syndromes used in decoding, reporting progress and stopping early if requested.
+// args:
+//   h - control matrix.
+//   stop - if stop is requested, calculation ends early and returned syndromes are incomplete.
+//   progress - gets updated while calculating. Can be nullptr.
+// returns:
+//   Syndromes - map of syndromes and their associated weight.
+Syndromes calculateSyndromes(const matrix& h, std::stop_token stop, SyndromeProgress* progress);
+
+// Computes syndrome weights on demand, instead of enumerating every coset before first decode.
+// Weight of syndrome is found by searching error vectors of up to maxWeight bits using columns of control matrix.
+// Found weights are kept in a fixed-capacity cache with CLOCK eviction, so memory use is capped.
+// Can be used from multiple threads at once.
+class SyndromeOracle {
+public:
+    // Constructs oracle for control matrix. Nothing is computed until first query.
+    // args:
+    //   h - control matrix.
+    //   maxWeight - maximum weight of error vectors to search (usually t+1).
+    //   capacity - maximum number of syndromes kept in cache.
+    SyndromeOracle(const matrix& h, uint8_t maxWeight, size_t capacity = 1 << 20);
+
+    // Returns weight of syndrome (weight of coset leader).
+    // If coset leader has more than maxWeight bits, returns maxWeight + 1.
+    // args:
+    //   syndrome - syndrome to get weight of.
+    // returns:
+    //   uint8_t - weight of syndrome.
+    uint8_t weight(vec syndrome) const;
+
+    // Returns maximum weight of error vectors that are searched.
+    // returns:
+    //   uint8_t - maximum searched weight.
+    uint8_t maxWeight() const { return m_maxWeight; }
+
+private:
+    struct CacheEntry {
+        vec syndrome;
+        uint8_t weight;
+        bool referenced;
+    };
+    // Cache is split into shards, so threads decoding different syndromes rarely wait for each other.
+    struct CacheShard {
+        std::mutex mutex;
+        std::unordered_map<vec, size_t> index; // syndrome -> position in entries
+        std::vector<CacheEntry> entries;
+        size_t hand = 0; // CLOCK hand
+    };
+    static constexpr size_t shardCount = 16;
+
+    uint8_t search(vec syndrome) const;
+    bool searchColumns(vec target, size_t start, size_t depth) const;
+
+    std::vector<vec> m_columns;
+    std::unordered_set<vec> m_columnSet;
+    uint8_t m_maxWeight;
+    size_t m_shardCapacity;
+    std::unique_ptr<CacheShard[]> m_shards;
+};
+
 // Encodes input vector using generator matrix.
 // Uses transposed generator matrix for faster encoding.
 // args:
@@ -29,6 +102,54 @@ Syndromes calculateSyndromes(const matrix& h);
 //   vec - encoded vector. It will be gTransposed.rows() bits long.
 vec encode(vec input, const matrix& gTransposed);
 
+// A helper function to get weight of syndrome. If syndrome is not in syndromes, returns 0.
+// Would be simpler to just index the hashmap, but that creates new entry if it doesn't exist, so can't be used with const.
+// args:
+//   syndromes - map of syndromes and their weights.
+//   syndrome - syndrome to get weight of.
+// returns:
+//   uint8_t - weight of syndrome.
+uint8_t getSyndromeWeight(const Syndromes& syndromes, vec syndrome);
+
+// Step-by-step decoding algorithm, shared by all decoders.
+// template args:
+//   SyndromeFn - callable returning syndrome of a vector (e.g. H * r).
+//   WeightFn - callable returning weight of a syndrome.
+// args:
+//   input - vector to decode.
+//   n - code length.
+//   k - code dimension.
+//   syndrome - used to compute syndromes.
+//   syndromeWeight - used to get weights of syndromes.
+// returns:
+//   vec - decoded vector.
+template <typename SyndromeFn, typename WeightFn>
+vec decodeStepByStep(vec input, size_t n, size_t k, SyndromeFn&& syndrome, WeightFn&& syndromeWeight) {
+    vec r = input;
+    // algorithm in the paper loops over N bits, but because we throw out last n-k bits, we can just not proccess them,
+    // because they don't affect previous bits, so we loop over K bits
+    for (size_t i = 0; i < k; i++) {
+        // compute H * r (syndrome)
+        vec rSyndrome = syndrome(r);
+        uint8_t rWeight = syndromeWeight(rSyndrome);
+
+        // if weight is 0, error fixed
+        if (rWeight == 0) break;
+
+        // compute H * (r + e_i) (syndrome with bit flipped)
+        vec rFlipped = r ^ (1ULL << (n - i - 1));
+        vec rFlippedSyndrome = syndrome(rFlipped);
+        uint8_t rFlippedWeight = syndromeWeight(rFlippedSyndrome);
+
+        // if flipped weight is smaller, set r to r + e_i
+        if (rFlippedWeight < rWeight) r = rFlipped;
+    }
+
+    // throw out n-k bits
+    r >>= n - k;
+    return r;
+}
+
 // Decodes input vector using syndromes and control matrix.
 // args:
 //   input - vector to decode.
@@ -37,3 +158,13 @@ vec encode(vec input, const matrix& gTransposed);
 // returns:
 //   vec - decoded vector.
 vec decode(vec input, const Syndromes& syndromes, const matrix& h);
+
+// Decodes input vector using syndrome oracle and control matrix.
+// Result matches decode with syndrome table, as long as oracle search is exact for visited syndromes.
+// args:
+//   input - vector to decode.
+//   oracle - oracle used to get syndrome weights.
+//   h - control matrix.
+// returns:
+//   vec - decoded vector.
+vec decode(vec input, const SyndromeOracle& oracle, const matrix& h);
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "fullDecodeTable.h"
+
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+#include <assert.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Table file: header followed by 2^n entries. Header is 64 bytes, so entries stay aligned when file is mapped.
+struct FullDecodeTableFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t n, k;
+    uint64_t codeHash; // hash of code and decoder, so table of other code with same n, k is rejected
+    uint8_t reserved[40];
+};
+static_assert(sizeof(FullDecodeTableFileHeader) == 64);
+
+constexpr char fullDecodeTableMagic[4] = { 'K', 'F', 'D', 'T' };
+constexpr uint32_t fullDecodeTableVersion = 1;
+
+// number of received words every thread decodes at once while building table
+constexpr size_t buildChunkSize = 1 << 16;
+
+static FullDecodeTableFileHeader makeFileHeader(size_t n, size_t k, uint64_t codeHash) {
+    FullDecodeTableFileHeader header = {};
+    std::memcpy(header.magic, fullDecodeTableMagic, sizeof(header.magic));
+    header.version = fullDecodeTableVersion;
+    header.n = static_cast<uint32_t>(n);
+    header.k = static_cast<uint32_t>(k);
+    header.codeHash = codeHash;
+    return header;
+}
+
+size_t fullDecodeTableBytes(size_t n, size_t k) {
+    return (size_t{1} << n) * withVectorWord(k, []<VectorWord T>() { return sizeof(T); });
+}
+
+FullDecodeTable::FullDecodeTable(size_t n, size_t k)
+    :   m_n(n), m_k(k), m_mask((vec{1} << n) - 1) {
+    assert(n <= fullDecodeTableMaxN);
+    assert(k < n);
+}
+
+FullDecodeTable::FullDecodeTable(size_t n, size_t k, const DecodeFn& decodeFn) : FullDecodeTable(n, k) {
+    m_owned.resize(fullDecodeTableBytes(n, k));
+    m_entries = m_owned.data();
+
+    // threads take chunks of received words one by one, so a slow chunk doesn't hold up the others
+    size_t count = size_t{1} << n;
+    size_t chunkCount = (count + buildChunkSize - 1) / buildChunkSize;
+    std::atomic<size_t> nextChunk = 0;
+    auto worker = [&] {
+        std::vector<vec> words(std::min(buildChunkSize, count));
+        withVectorWord(k, [&]<VectorWord T>() {
+            T* entries = reinterpret_cast<T*>(m_owned.data());
+            for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+                size_t begin = chunk * buildChunkSize;
+                std::span<vec> part(words.data(), std::min(buildChunkSize, count - begin));
+                for (size_t i = 0; i < part.size(); i++) part[i] = begin + i;
+                decodeFn(part);
+                for (size_t i = 0; i < part.size(); i++) entries[begin + i] = static_cast<T>(part[i]);
+            }
+        });
+    };
+    size_t threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, chunkCount);
+    std::vector<std::jthread> threads;
+    for (size_t i = 1; i < threadCount; i++) threads.emplace_back(worker);
+    worker();
+}
+
+FullDecodeTable::~FullDecodeTable() {
+#ifdef __linux__
+    if (m_mapping) munmap(m_mapping, m_mappingSize);
+#endif
+}
+
+std::shared_ptr<const FullDecodeTable> FullDecodeTable::load(const std::string& path, size_t n, size_t k, uint64_t codeHash) {
+    FullDecodeTableFileHeader expected = makeFileHeader(n, k, codeHash);
+    size_t fileSize = sizeof(expected) + fullDecodeTableBytes(n, k);
+    std::shared_ptr<FullDecodeTable> table(new FullDecodeTable(n, k));
+#ifdef __linux__
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != fileSize) {
+        close(fd);
+        return nullptr;
+    }
+    // pages are read in right away, so decoding doesn't stop on page faults
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return nullptr;
+    table->m_mapping = mapping;
+    table->m_mappingSize = fileSize;
+    if (std::memcmp(mapping, &expected, sizeof(expected)) != 0) return nullptr;
+    table->m_entries = static_cast<const uint8_t*>(mapping) + sizeof(expected);
+#else
+    std::ifstream file(path, std::ios::binary);
+    FullDecodeTableFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(&header, &expected, sizeof(header)) != 0) return nullptr;
+    table->m_owned.resize(fileSize - sizeof(header));
+    if (!file.read(reinterpret_cast<char*>(table->m_owned.data()), table->m_owned.size()) || file.peek() != EOF) return nullptr;
+    table->m_entries = table->m_owned.data();
+#endif
+    return table;
+}
+
+bool FullDecodeTable::save(const std::string& path, uint64_t codeHash) const {
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        FullDecodeTableFileHeader header = makeFileHeader(m_n, m_k, codeHash);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(m_entries), fullDecodeTableBytes(m_n, m_k));
+        if (!file.flush()) {
+            file.close();
+            std::filesystem::remove(temporaryPath);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) std::filesystem::remove(temporaryPath, error);
+    return !error;
+}
+
+vec FullDecodeTable::decode(vec input) const {
+    return withVectorWord(m_k, [&]<VectorWord W>() -> vec {
+        return reinterpret_cast<const W*>(m_entries)[input & m_mask];
+    });
+}
+
+template <VectorWord T>
+void FullDecodeTable::decode(std::type_identity_t<std::span<const T>> input, std::type_identity_t<std::span<T>> output) const {
+    assert(input.size() == output.size());
+    withVectorWord(m_k, [&]<VectorWord W>() {
+        const W* entries = reinterpret_cast<const W*>(m_entries);
+        for (size_t i = 0; i < input.size(); i++) {
+            output[i] = static_cast<T>(entries[input[i] & m_mask]);
+        }
+    });
+}
+template void FullDecodeTable::decode<uint8_t>(std::span<const uint8_t>, std::span<uint8_t>) const;
+template void FullDecodeTable::decode<uint16_t>(std::span<const uint16_t>, std::span<uint16_t>) const;
+template void FullDecodeTable::decode<uint32_t>(std::span<const uint32_t>, std::span<uint32_t>) const;
+template void FullDecodeTable::decode<uint64_t>(std::span<const uint64_t>, std::span<uint64_t>) const;
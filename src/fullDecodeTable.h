@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <span>
+#include <memory>
+#include <functional>
+#include <string>
+
+#include "math.h"
+
+// Largest code length for which full decode table can be built (2^n entries).
+constexpr size_t fullDecodeTableMaxN = 32;
+
+// Returns size of full decode table in bytes: 2^n entries of the narrowest word that holds k bits.
+// args:
+//   n - code length.
+//   k - code dimension.
+// returns:
+//   size_t - size of table in bytes.
+size_t fullDecodeTableBytes(size_t n, size_t k);
+
+// Full decode table: decoded message of every possible received word, indexed by the word itself.
+// Decoding is one load, without syndrome computation or loops, so it suits short codes (n up to about 24).
+// Entries are stored in the narrowest word that holds k bits. Table is built once from another decoder,
+// so results are identical to it, and can be saved to a file and mapped back into memory.
+class FullDecodeTable {
+public:
+    // Decodes vectors in place with the decoder the table is built from.
+    using DecodeFn = std::function<void(std::span<vec>)>;
+
+    // Builds table by decoding every received word, on all hardware threads.
+    // args:
+    //   n - code length, at most fullDecodeTableMaxN.
+    //   k - code dimension.
+    //   decodeFn - decoder to build table from. Called from several threads at once, so it must be thread safe.
+    FullDecodeTable(size_t n, size_t k, const DecodeFn& decodeFn);
+
+    // Loads table from file written by save. File is mapped into memory (read into memory if mapping is not available).
+    // args:
+    //   path - file to load.
+    //   n - code length.
+    //   k - code dimension.
+    //   codeHash - hash identifying code and decoder the table must be built from.
+    // returns:
+    //   std::shared_ptr<const FullDecodeTable> - loaded table, nullptr if file doesn't exist or is for another code.
+    static std::shared_ptr<const FullDecodeTable> load(const std::string& path, size_t n, size_t k, uint64_t codeHash);
+
+    // Saves table to file. File is written under temporary name and renamed, so it is never seen half written.
+    // args:
+    //   path - file to write.
+    //   codeHash - hash identifying code and decoder, checked by load.
+    // returns:
+    //   bool - true on success.
+    bool save(const std::string& path, uint64_t codeHash) const;
+
+    ~FullDecodeTable();
+    FullDecodeTable(const FullDecodeTable&) = delete;
+    FullDecodeTable& operator=(const FullDecodeTable&) = delete;
+
+    // Returns code length.
+    size_t n() const { return m_n; }
+
+    // Returns code dimension.
+    size_t k() const { return m_k; }
+
+    // Decodes input vector.
+    // args:
+    //   input - vector to decode, n bits. Higher bits are ignored.
+    // returns:
+    //   vec - decoded message, k bits.
+    vec decode(vec input) const;
+
+    // Decodes a batch of vectors.
+    // template args:
+    //   T - word vectors are stored in, must have at least n bits. vec if not given.
+    // args:
+    //   input - vectors to decode.
+    //   output - decoded vectors. Must be the same size as input, can be the same span.
+    template <VectorWord T = vec>
+    void decode(std::type_identity_t<std::span<const T>> input, std::type_identity_t<std::span<T>> output) const;
+
+private:
+    FullDecodeTable(size_t n, size_t k);
+
+    size_t m_n, m_k;
+    vec m_mask; // n lowest bits
+    const uint8_t* m_entries = nullptr; // points into m_owned or into mapped file
+    std::vector<uint8_t> m_owned;
+    void* m_mapping = nullptr;
+    size_t m_mappingSize = 0;
+};
@@ -1,6 +1,11 @@
 #include "io.h"
 
+#include <cstdio>
+#include <thread>
+#include <chrono>
+
 #include "encoder.h"
+#include "autotune.h"
 
 std::string printVec(vec v, size_t bits) {
     std::string str(bits, '0');
@@ -95,6 +100,14 @@ vec userInputVector(std::string_view prompt, size_t len) {
     }
 }
 
+vec userInputPolynomial(std::string_view prompt, size_t degree) {
+    while (true) {
+        vec result = userInputVector(prompt, degree + 1);
+        if ((result >> degree) & 1) return result;
+        std::print("Klaida! Polinomo laipsnis turi buti {} (pirmas koeficientas turi buti 1).\n", degree);
+    }
+}
+
 std::string userInputString(std::string_view promt) {
     std::string result;
     std::print("{}: ", promt);
@@ -137,10 +150,21 @@ CommonParams userInputCommonParameters() {
     size_t inputMatRows = p.k;
     size_t inputMatCols = p.n - p.k;
     matrix in(inputMatRows, inputMatCols);
-    if (userInputChoice("Ar norite ivesti generuojancia matrica ranka?")) {
+    std::vector<std::string_view> sources = { "ivesti G dali A ranka", "atsitiktine G dalis A" };
+    if (p.k < p.n) sources.push_back("ivesti generuojanti polinoma g(x) (ciklinis kodas)");
+    int32_t source = userInputChoiceArray("Kaip sudaryti generuojancia matrica G", sources);
+    if (source == 1) {
         in = userInputMatrix("Iveskite generuojancios matricos G dali A", inputMatRows, inputMatCols);
-    } else {
+    } else if (source == 2) {
         in = randomMatrix(inputMatRows, inputMatCols);
+    } else {
+        vec generator = userInputPolynomial("Iveskite generuojanti polinoma g(x), koeficientus nuo x^(n-k) iki x^0", p.n - p.k);
+        p.cyclic = std::make_shared<CyclicCode>(p.n, generator);
+        // x^n mod g(x), computed as x * (x^(n-1) mod g(x)), because x^64 doesn't fit
+        if (p.cyclic->remainder(p.cyclic->remainder(vec{1} << (p.n - 1)) << 1) != 1) {
+            std::print("Polinomas g(x) nedalija x^n+1, todel kodas nera ciklinis (sutrumpintas polinominis kodas).\n");
+        }
+        in = p.cyclic->generatorMatrixA();
     }
     matrix identity = matrix(p.k, p.k, true);
     p.g = identity.append(in);
@@ -150,8 +174,102 @@ CommonParams userInputCommonParameters() {
 
     // calculate control matrix and syndromes
     p.h = calculateControlMatrix(p.g);
-    std::print("Generuojami sindromai ...\n");
-    p.syndromes = calculateSyndromes(p.h);
+    if (p.k <= mlDecoderMaxK && userInputChoice("Ar dekoduoti didziausio tiketinumo metodu (lyginant su visais 2^k kodo zodziais)?")) {
+        p.mlDecoder = std::make_shared<MlDecoder>(p.gTransposed);
+        return p;
+    }
+    bool tableTooBig = p.n - p.k > maxSyndromeBits;
+    if (tableTooBig) std::print("Sindromu lentele (2^{} irasu) netilptu i atminti, sindromai bus skaiciuojami pagal poreiki.\n", p.n - p.k);
+    if (tableTooBig || (p.n - p.k >= lazySyndromeThreshold && userInputChoice("Ar skaiciuoti sindromus pagal poreiki?"))) {
+        size_t maxWeight = userInputNumber<size_t>("Iveskite didziausia ieskomo klaidos vektoriaus svori (t+1): ", 1, p.n);
+        p.syndromeOracle = std::make_shared<SyndromeOracle>(p.h, static_cast<uint8_t>(maxWeight));
+        return p;
+    }
+    std::print("Sindromai generuojami fone ...\n");
+    p.syndromes = std::make_shared<AsyncSyndromes>(p.h);
 
     return p;
-}
\ No newline at end of file
+}
+
+CommonParams makeCommonParams(size_t n, size_t k, const matrix& a, bool wait) {
+    CommonParams p;
+    p.n = n;
+    p.k = k;
+    p.g = matrix(k, k, true).append(a);
+    p.gTransposed = p.g.transpose();
+    p.h = calculateControlMatrix(p.g);
+    p.syndromes = std::make_shared<AsyncSyndromes>(p.h);
+    if (wait) p.syndromes->get();
+    return p;
+}
+
+const SyndromeData& waitForSyndromes(const AsyncSyndromes& syndromes) {
+    bool shown = false;
+    while (!syndromes.ready()) {
+        const SyndromeProgress& progress = syndromes.progress();
+        std::print("\rGeneruojami sindromai: {}/{} (svoris {}, liko ~{:.0f}s)   ",
+                   progress.found.load(), progress.total.load(), progress.weight.load(), std::max(syndromes.etaSeconds(), 0.0));
+        std::fflush(stdout);
+        shown = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    }
+    if (shown) std::print("\n");
+    return syndromes.get();
+}
+
+vec encode(vec input, const CommonParams& params) {
+    if (params.cyclic && params.cyclicEncode) return params.cyclic->encode(input);
+    return encode(input, params.gTransposed);
+}
+
+vec decode(vec input, const CommonParams& commonParams) {
+    const CommonParams& params = tunedParams(commonParams);
+    if (params.fullDecodeTable) return params.fullDecodeTable->decode(input);
+    if (params.mlDecoder) return params.mlDecoder->decode(input, params.decodeLevel);
+    if (params.syndromeOracle) return decode(input, *params.syndromeOracle, params.h);
+    // reordered table, also for cyclic codes: their polynomial syndromes are H * r too
+    const SyndromeData& syndromeData = waitForSyndromes(*params.syndromes);
+    return decodeWithTable(input, syndromeData.table, syndromeData.tableHTransposed);
+}
+
+template <VectorWord T>
+void encodeVectors(std::type_identity_t<std::span<T>> vectors, const CommonParams& params) {
+    for (auto& v : vectors) {
+        v = static_cast<T>(encode(v, params));
+    }
+}
+template void encodeVectors<uint8_t>(std::span<uint8_t>, const CommonParams&);
+template void encodeVectors<uint16_t>(std::span<uint16_t>, const CommonParams&);
+template void encodeVectors<uint32_t>(std::span<uint32_t>, const CommonParams&);
+template void encodeVectors<uint64_t>(std::span<uint64_t>, const CommonParams&);
+
+template <VectorWord T>
+void decodeVectors(std::type_identity_t<std::span<T>> vectors, const CommonParams& commonParams) {
+    const CommonParams& params = tunedParams(commonParams);
+    if (params.fullDecodeTable) {
+        params.fullDecodeTable->decode<T>(vectors, vectors);
+        return;
+    }
+    if (params.mlDecoder) {
+        if constexpr (std::is_same_v<T, vec>) {
+            params.mlDecoder->decode(vectors, vectors, params.decodeLevel);
+        } else {
+            for (auto& v : vectors) {
+                v = static_cast<T>(params.mlDecoder->decode(v, params.decodeLevel));
+            }
+        }
+        return;
+    }
+    if (params.syndromeOracle) {
+        for (auto& v : vectors) {
+            v = static_cast<T>(decode(v, *params.syndromeOracle, params.h));
+        }
+        return;
+    }
+    const SyndromeData& syndromeData = waitForSyndromes(*params.syndromes);
+    decodeBatch<T>(vectors, vectors, syndromeData.table, syndromeData.tableH, params.decodeLevel);
+}
+template void decodeVectors<uint8_t>(std::span<uint8_t>, const CommonParams&);
+template void decodeVectors<uint16_t>(std::span<uint16_t>, const CommonParams&);
+template void decodeVectors<uint32_t>(std::span<uint32_t>, const CommonParams&);
+template void decodeVectors<uint64_t>(std::span<uint64_t>, const CommonParams&);
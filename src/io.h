@@ -5,9 +5,15 @@
 #include <string_view>
 #include <string>
 #include <vector>
+#include <memory>
 
 #include "math.h"
 #include "encoder.h"
+#include "batchDecoder.h"
+#include "asyncSyndromes.h"
+#include "cyclic.h"
+#include "mlDecoder.h"
+#include "fullDecodeTable.h"
 
 // prints vector to string.
 // args:
@@ -56,6 +62,14 @@ matrix userInputMatrix(std::string_view prompt, size_t rows, size_t cols);
 //   vec - vector entered by user.
 vec userInputVector(std::string_view prompt, size_t len);
 
+// Promts user to input a polynomial as its coefficients, from highest power to x^0.
+// args:
+//   prompt - message to show before input.
+//   degree - degree of polynomial. Coefficient of x^degree must be 1.
+// returns:
+//   vec - polynomial entered by user, bit i holds coefficient of x^i.
+vec userInputPolynomial(std::string_view prompt, size_t degree);
+
 // Promts user to input a string.
 // args:
 //   prompt - message to show before input.
@@ -70,18 +84,85 @@ std::string userInputString(std::string_view promt);
 //   std::string - multiline string entered by the user.
 std::string userInputMultilineString(std::string_view promt);
 
+struct LazyAutotune;
+
 // this struct stores common parameters used in all scenarios.
 struct CommonParams {
     size_t n, k;
     matrix g, h, gTransposed;
-    Syndromes syndromes;
+    std::shared_ptr<AsyncSyndromes> syndromes; // generated in background, decoding waits for them
+    std::shared_ptr<const SyndromeOracle> syndromeOracle; // set if syndromes are computed on demand
+    std::shared_ptr<const CyclicCode> cyclic; // set if code is given by generator polynomial
+    std::shared_ptr<const MlDecoder> mlDecoder; // set if vectors are decoded by comparing with all codewords
+    std::shared_ptr<const FullDecodeTable> fullDecodeTable; // set if decoded vectors are looked up in a table of all received words
+    SimdLevel decodeLevel = detectSimdLevel(); // instruction set used for decoding, can be lowered by autotuning
+    std::shared_ptr<LazyAutotune> lazyAutotune; // set if decoder gets autotuned on first decode (see autotune.h)
+    bool cyclicEncode = true; // if code is cyclic, encode by polynomial division instead of G
 };
 
+// Syndromes are computed on demand when n-k is at least this big, if user chooses to,
+// and always when n-k is bigger than maxSyndromeBits (syndrome table would not fit into memory).
+constexpr size_t lazySyndromeThreshold = 20;
+
 // Promts user to input common to all scenarios parameters.
 // returns:
 //   CommonParams - common parameters entered by user.
 CommonParams userInputCommonParameters();
 
+// Builds common parameters without asking the user.
+// args:
+//   n - code length.
+//   k - code dimension.
+//   a - part A of generator matrix (k rows, n-k cols).
+//   wait - wait until syndromes are generated, otherwise they are generated in background.
+// returns:
+//   CommonParams - common parameters for given code.
+CommonParams makeCommonParams(size_t n, size_t k, const matrix& a, bool wait = true);
+
+// Waits until syndromes are generated, showing progress while waiting.
+// args:
+//   syndromes - syndromes being generated.
+// returns:
+//   const SyndromeData& - generated syndromes.
+const SyndromeData& waitForSyndromes(const AsyncSyndromes& syndromes);
+
+// Encodes input vector with code from common parameters.
+// args:
+//   input - vector to encode.
+//   params - common parameters.
+// returns:
+//   vec - encoded vector.
+vec encode(vec input, const CommonParams& params);
+
+// Decodes input vector with syndromes (or maximum likelihood decoder, or full decode table) from common parameters.
+// If syndromes are still being generated, waits for them and shows progress. If decoder is tuned lazily, tunes it on first call.
+// args:
+//   input - vector to decode.
+//   params - common parameters.
+// returns:
+//   vec - decoded vector.
+vec decode(vec input, const CommonParams& params);
+
+// Encodes vectors in place with code from common parameters.
+// template args:
+//   T - word vectors are stored in, must have at least n bits. vec if not given.
+// args:
+//   vectors - vectors to encode.
+//   params - common parameters.
+template <VectorWord T = vec>
+void encodeVectors(std::type_identity_t<std::span<T>> vectors, const CommonParams& params);
+
+// Decodes vectors in place with syndromes (or maximum likelihood decoder, or full decode table) from common parameters.
+// Uses batch decoding unless syndromes are computed on demand.
+// If syndromes are still being generated, waits for them and shows progress. If decoder is tuned lazily, tunes it on first call.
+// template args:
+//   T - word vectors are stored in, must have at least n bits. vec if not given.
+// args:
+//   vectors - vectors to decode.
+//   params - common parameters.
+template <VectorWord T = vec>
+void decodeVectors(std::type_identity_t<std::span<T>> vectors, const CommonParams& params);
+
 // Promts user to input a number.
 // template args:
 //   T - type of number to input. Should be passed explicitly to avoid ambiguity.
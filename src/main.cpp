@@ -1,14 +1,23 @@
+#include <charconv>
+#include <cstring>
+
 #include "io.h"
 #include "scenarios/vectorEncoding.h"
 #include "scenarios/textEncoding.h"
 #include "scenarios/imageEncoding.h"
+#include "server.h"
+#include "autotune.h"
+#include "perfCheck.h"
+#include "benchmark.h"
+#include "pipeFilter.h"
 
 // Allows user to select a scenario.
 // args:
 //   p - ref to program parameters used in scenarios. Can be modified if user chooses to.
+//   tableBudget - largest allowed full decode table size in bytes (see autotuneLazily).
 // returns:
 //   false if user chose to exit, true otherwise.
-bool chooseMode(CommonParams& p) {
+bool chooseMode(CommonParams& p, size_t tableBudget) {
     int32_t selection = userInputChoiceArray("Pasirinkite veiksma", {
         "vektoriaus kodavimas",
         "teksto kodavimas",
@@ -27,7 +36,9 @@ bool chooseMode(CommonParams& p) {
         imageEncodingStart(p);
         break;
     case 4:
+        if (p.syndromes) p.syndromes->cancel(); // old syndromes won't be needed anymore
         p = userInputCommonParameters();
+        autotuneLazily(p, tableBudget);
         break;
     default:
         return false;
@@ -36,8 +47,40 @@ bool chooseMode(CommonParams& p) {
     return true;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // server mode: program serve [socket path]
+    if (argc >= 2 && std::string_view(argv[1]) == "serve") {
+        return runServer(argc >= 3 ? argv[2] : defaultSocketPath);
+    }
+    // performance check: program perfcheck [baseline path] [summary path] [--update]
+    if (argc >= 2 && std::string_view(argv[1]) == "perfcheck") {
+        bool update = std::string_view(argv[argc - 1]) == "--update";
+        int paths = argc - 2 - update;
+        return runPerfCheck(paths >= 1 ? argv[2] : defaultPerfBaselinePath, paths >= 2 ? argv[3] : defaultPerfSummaryPath, update);
+    }
+    // benchmarks: program benchmark <name> [flags], see benchmark.h
+    if (argc >= 2 && std::string_view(argv[1]) == "benchmark") {
+        return runBenchmark(argc, argv);
+    }
+    // pipe-filter mode: program encode|channel|decode [flags] < input > output
+    if (argc >= 2 && (std::string_view(argv[1]) == "encode" || std::string_view(argv[1]) == "channel" || std::string_view(argv[1]) == "decode")) {
+        return runPipeFilter(argc, argv);
+    }
+
+    // interactive mode: program [--table-budget MIB]
+    size_t tableBudget = defaultFullDecodeTableBudget;
+    if (argc >= 3 && std::string_view(argv[1]) == "--table-budget") {
+        size_t mebibytes = 0;
+        auto [end, error] = std::from_chars(argv[2], argv[2] + std::strlen(argv[2]), mebibytes);
+        if (error != std::errc() || *end != '\0' || mebibytes > (SIZE_MAX >> 20)) {
+            std::print(stderr, "Klaida! Netinkama '--table-budget' reiksme '{}'.\n", argv[2]);
+            return 1;
+        }
+        tableBudget = mebibytes << 20;
+    }
+
     CommonParams p = userInputCommonParameters();
-    while (chooseMode(p)) {}
+    autotuneLazily(p, tableBudget);
+    while (chooseMode(p, tableBudget)) {}
     return 0;
 }
\ No newline at end of file
@@ -5,14 +5,16 @@
 #include <bit>
 #include <assert.h>
 
-std::vector<vec> vectorsFromData(std::span<const uint8_t> data, size_t vecSize, size_t& lastVectorPadding) {
+template <VectorWord T>
+std::vector<T> vectorsFromData(std::span<const uint8_t> data, size_t vecSize, size_t& lastVectorPadding) {
+    assert(vecSize <= sizeof(T) * 8);
     // reserve memory for vectors
-    std::vector<vec> vectors;
+    std::vector<T> vectors;
     size_t vectorCount = data.size() * 8 / vecSize;
     if (vectorCount * vecSize < data.size() * 8) vectorCount++;
     vectors.reserve(vectorCount);
 
-    vec current = 0;
+    T current = 0;
     size_t currentSize = 0;
     for (uint8_t byte : data) {
         for (size_t i = 0; i < 8; i++) {
@@ -20,7 +22,7 @@ std::vector<vec> vectorsFromData(std::span<const uint8_t> data, size_t vecSize,
             uint8_t bit = (byte >> (7 - i)) & 1;
 
             // set bit
-            current = (current << 1) | bit;
+            current = static_cast<T>((current << 1) | bit);
             currentSize++;
             if (currentSize == vecSize) {
                 vectors.push_back(current);
@@ -33,15 +35,25 @@ std::vector<vec> vectorsFromData(std::span<const uint8_t> data, size_t vecSize,
     lastVectorPadding = 0;
     if (currentSize != 0) {
         lastVectorPadding = vecSize - currentSize;
-        vectors.push_back(current << lastVectorPadding);
+        vectors.push_back(static_cast<T>(current << lastVectorPadding));
     }
     return vectors;
 }
+template std::vector<uint8_t> vectorsFromData<uint8_t>(std::span<const uint8_t>, size_t, size_t&);
+template std::vector<uint16_t> vectorsFromData<uint16_t>(std::span<const uint8_t>, size_t, size_t&);
+template std::vector<uint32_t> vectorsFromData<uint32_t>(std::span<const uint8_t>, size_t, size_t&);
+template std::vector<uint64_t> vectorsFromData<uint64_t>(std::span<const uint8_t>, size_t, size_t&);
+
+size_t vectorPadding(size_t byteCount, size_t vecSize) {
+    size_t remainder = byteCount * 8 % vecSize;
+    return remainder == 0 ? 0 : vecSize - remainder;
+}
 std::vector<vec> vectorsFromString(std::string_view data, size_t vecSize, size_t& lastVectorPadding) {
     std::span<const uint8_t> span = { reinterpret_cast<const uint8_t*>(data.data()), data.size() };
     return vectorsFromData(span, vecSize, lastVectorPadding);
 }
-std::vector<uint8_t> vectorsToData(std::span<const vec> vecs, size_t vecSize, size_t lastVectorPadding) {
+template <VectorWord T>
+std::vector<uint8_t> vectorsToData(std::type_identity_t<std::span<const T>> vecs, size_t vecSize, size_t lastVectorPadding) {
     // reserve memory for data
     std::vector<uint8_t> data;
     size_t byteCount = (vecs.size() * vecSize - lastVectorPadding) / 8;
@@ -50,7 +62,7 @@ std::vector<uint8_t> vectorsToData(std::span<const vec> vecs, size_t vecSize, si
     uint8_t current = 0;
     size_t currentSize = 0;
     for (size_t vecIndex = 0; vecIndex < vecs.size(); vecIndex++) {
-        vec vector = vecs[vecIndex];
+        T vector = vecs[vecIndex];
         if (vecIndex == vecs.size() - 1) {
             vector >>= lastVectorPadding;
             vecSize -= lastVectorPadding;
@@ -71,6 +83,11 @@ std::vector<uint8_t> vectorsToData(std::span<const vec> vecs, size_t vecSize, si
     }
     return data;
 }
+template std::vector<uint8_t> vectorsToData<uint8_t>(std::span<const uint8_t>, size_t, size_t);
+template std::vector<uint8_t> vectorsToData<uint16_t>(std::span<const uint16_t>, size_t, size_t);
+template std::vector<uint8_t> vectorsToData<uint32_t>(std::span<const uint32_t>, size_t, size_t);
+template std::vector<uint8_t> vectorsToData<uint64_t>(std::span<const uint64_t>, size_t, size_t);
+
 std::string vectorsToString(std::span<const vec> vecs, size_t vecSize, size_t lastVectorPadding) {
     std::vector<uint8_t> data = vectorsToData(vecs, vecSize, lastVectorPadding);
     return std::string(reinterpret_cast<const char*>(data.data()), data.size());
@@ -107,7 +124,7 @@ void matrix::setVal(size_t row, size_t col, uint8_t val) {
     col = 63 - (col + m_bitOffset);
     assert(col < 64);
     m_data[row] &= ~(1ULL << col); // clear bit
-    m_data[row] |= val << col; // set to val
+    m_data[row] |= vec{val} << col; // set to val
 }
 
 vec matrix::multVectorOnRight(vec inputVec) const {
@@ -180,3 +197,15 @@ matrix randomMatrix(size_t rows, size_t cols) {
     }
     return m;
 }
+matrix randomMatrix(size_t rows, size_t cols, uint64_t seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<uint16_t> distribution(0, 1);
+
+    matrix m(rows, cols);
+    for (size_t i = 0; i < m.rows(); i++) {
+        for (size_t j = 0; j < m.cols(); j++) {
+            m.setVal(i, j, distribution(generator));
+        }
+    }
+    return m;
+}
\ No newline at end of file
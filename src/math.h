@@ -6,28 +6,58 @@
 #include <string_view>
 #include <string>
 #include <span>
+#include <ranges>
+#include <generator>
+#include <concepts>
+#include <type_traits>
 
 using vec = uint64_t;
 
+// Unsigned words that vectors can be stored in. Short codes can use narrower words than vec,
+// so bulk buffers take less memory and bandwidth. Values are still passed around as vec.
+template <typename T>
+concept VectorWord = std::same_as<T, uint8_t> || std::same_as<T, uint16_t> || std::same_as<T, uint32_t> || std::same_as<T, uint64_t>;
+
+// Calls fn with the narrowest VectorWord that has at least 'bits' bits, e.g.
+// withVectorWord(n, [&]<VectorWord T>() { std::vector<T> vectors; ... });
+// args:
+//   bits - number of bits that must fit into the word (at most 64).
+//   fn - callable with one template parameter.
+// returns:
+//   result of fn.
+template <typename Fn>
+decltype(auto) withVectorWord(size_t bits, Fn&& fn) {
+    if (bits <= 8) return fn.template operator()<uint8_t>();
+    if (bits <= 16) return fn.template operator()<uint16_t>();
+    if (bits <= 32) return fn.template operator()<uint32_t>();
+    return fn.template operator()<uint64_t>();
+}
+
 
 // Converts byte array to vectors.
 // if data size is not multiple of vecSize, last vector will be smaller, so it will be padded.
+// template args:
+//   T - word vectors are stored in, must have at least vecSize bits. vec if not given.
 // args:
 //   data - byte array to convert.
 //   vecSize - size of each vector in bits.
 //   lastVectorPadding - gets set to number of padding bits in last vector.
 // returns:
-//   std::vector<vec> - data divided into vectors.
-std::vector<vec> vectorsFromData(std::span<const uint8_t> data, size_t vecSize, size_t& lastVectorPadding);
+//   std::vector<T> - data divided into vectors.
+template <VectorWord T = vec>
+std::vector<T> vectorsFromData(std::span<const uint8_t> data, size_t vecSize, size_t& lastVectorPadding);
 
 // Converts vector array to byte array.
+// template args:
+//   T - word vectors are stored in. vec if not given.
 // args:
 //   vecs - vectors to convert to bytes.
 //   vecSize - size of each vector in bits.
 //   lastVectorPadding - number of padding bits in last vector.
 // returns:
 //   std::vector<uint8_t> - vectors converted to bytes.
-std::vector<uint8_t> vectorsToData(std::span<const vec> vecs, size_t vecSize, size_t lastVectorPadding);
+template <VectorWord T = vec>
+std::vector<uint8_t> vectorsToData(std::type_identity_t<std::span<const T>> vecs, size_t vecSize, size_t lastVectorPadding);
 
 // Converts string to vectors.
 // if data size is not multiple of vecSize, last vector will be smaller, so it will be padded.
@@ -48,6 +78,37 @@ std::vector<vec> vectorsFromString(std::string_view data, size_t vecSize, size_t
 //   std::string - vectors converted to string.
 std::string vectorsToString(std::span<const vec> vecs, size_t vecSize, size_t lastVectorPadding);
 
+// Returns number of padding bits in last vector when data of given size is divided into vectors.
+// args:
+//   byteCount - size of data in bytes.
+//   vecSize - size of each vector in bits.
+// returns:
+//   size_t - number of padding bits in last vector (0 if data divides evenly).
+size_t vectorPadding(size_t byteCount, size_t vecSize);
+
+// Lazily converts bytes to vectors. Same result as vectorsFromData, but vectors are produced one at a time.
+// if data size is not multiple of vecSize, last vector will be smaller, so it will be padded (see vectorPadding).
+// args:
+//   data - bytes to convert. Lvalue ranges are referenced and must outlive the generator, rvalue ranges are moved into it.
+//   vecSize - size of each vector in bits.
+// returns:
+//   std::generator<vec> - vectors of data.
+template <std::ranges::viewable_range R>
+    requires std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, uint8_t>
+std::generator<vec> lazyVectorsFromData(R&& data, size_t vecSize);
+
+// Lazily converts vectors to bytes. Same result as vectorsToData, but bytes are produced one at a time.
+// Only one vector is read ahead, so vectors can come from another lazy range.
+// args:
+//   vecs - vectors to convert. Lvalue ranges are referenced and must outlive the generator, rvalue ranges are moved into it.
+//   vecSize - size of each vector in bits.
+//   lastVectorPadding - number of padding bits in last vector.
+// returns:
+//   std::generator<uint8_t> - bytes of vectors.
+template <std::ranges::viewable_range R>
+    requires std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, vec>
+std::generator<uint8_t> lazyVectorsToData(R&& vecs, size_t vecSize, size_t lastVectorPadding);
+
 class matrix {
 public:
     // constructs an empty matrix (rows = 0, cols = 0).
@@ -142,4 +203,76 @@ private:
 //   cols - number of columns in matrix.
 // returns:
 //   matrix - random matrix with given dimensions.
-matrix randomMatrix(size_t rows, size_t cols);
\ No newline at end of file
+matrix randomMatrix(size_t rows, size_t cols);
+
+// Generates a random matrix from given seed. Same seed always gives the same matrix.
+// args:
+//   rows - number of rows in matrix.
+//   cols - number of columns in matrix.
+//   seed - seed of random generator.
+// returns:
+//   matrix - random matrix with given dimensions.
+matrix randomMatrix(size_t rows, size_t cols, uint64_t seed);
+
+namespace detail {
+    template <std::ranges::view V>
+    std::generator<vec> lazyVectorsFromView(V data, size_t vecSize) {
+        vec current = 0;
+        size_t currentSize = 0;
+        for (uint8_t byte : data) {
+            for (size_t i = 0; i < 8; i++) {
+                current = (current << 1) | ((byte >> (7 - i)) & 1);
+                currentSize++;
+                if (currentSize == vecSize) {
+                    co_yield current;
+                    current = 0;
+                    currentSize = 0;
+                }
+            }
+        }
+        if (currentSize != 0) co_yield current << (vecSize - currentSize);
+    }
+
+    template <std::ranges::view V>
+    std::generator<uint8_t> lazyVectorsToView(V vecs, size_t vecSize, size_t lastVectorPadding) {
+        uint8_t current = 0;
+        size_t currentSize = 0;
+        auto it = std::ranges::begin(vecs);
+        auto end = std::ranges::end(vecs);
+        if (it == end) co_return;
+        // padding is only known to apply once there is no next vector, so one vector is held back
+        vec vector = *it;
+        while (true) {
+            ++it;
+            bool last = it == end;
+            size_t size = vecSize;
+            if (last) {
+                vector >>= lastVectorPadding;
+                size -= lastVectorPadding;
+            }
+            for (size_t i = 0; i < size; i++) {
+                current = (current << 1) | ((vector >> (size - 1 - i)) & 1);
+                currentSize++;
+                if (currentSize == 8) {
+                    co_yield current;
+                    current = 0;
+                    currentSize = 0;
+                }
+            }
+            if (last) break;
+            vector = *it;
+        }
+    }
+}
+
+template <std::ranges::viewable_range R>
+    requires std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, uint8_t>
+std::generator<vec> lazyVectorsFromData(R&& data, size_t vecSize) {
+    return detail::lazyVectorsFromView(std::views::all(std::forward<R>(data)), vecSize);
+}
+
+template <std::ranges::viewable_range R>
+    requires std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, vec>
+std::generator<uint8_t> lazyVectorsToData(R&& vecs, size_t vecSize, size_t lastVectorPadding) {
+    return detail::lazyVectorsToView(std::views::all(std::forward<R>(vecs)), vecSize, lastVectorPadding);
+}
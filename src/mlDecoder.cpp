@@ -0,0 +1,120 @@
+#include "mlDecoder.h"
+
+#include <bit>
+#include <algorithm>
+#include <assert.h>
+
+#include "encoder.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define ML_DECODER_X86
+#endif
+
+MlDecoder::MlDecoder(const matrix& gTransposed) : m_n(gTransposed.rows()), m_k(gTransposed.cols()) {
+    assert(m_k <= mlDecoderMaxK);
+    size_t count = size_t{1} << m_k;
+    m_codebook.resize((count + 7) / 8);
+    vec* codewords = m_codebook.data()->codewords;
+    for (size_t i = 0; i < count; i++) {
+        codewords[i] = encode(i, gTransposed);
+    }
+    // unused slots repeat codeword 0, they never win because ties go to the lower message
+    std::fill(codewords + count, codewords + m_codebook.size() * 8, codewords[0]);
+}
+
+// Distance and message are packed into one key (distance << 32 | message),
+// so the smallest key is the closest codeword with the lowest message.
+static uint64_t nearestScalar(vec r, const vec* codewords, size_t count) {
+    uint64_t best = ~uint64_t{0};
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = (static_cast<uint64_t>(std::popcount(r ^ codewords[i])) << 32) | i;
+        best = std::min(best, key);
+    }
+    return best;
+}
+
+#ifdef ML_DECODER_X86
+
+// Counts set bits of every 64-bit lane. Without AVX-512 VPOPCNTDQ, bits of every nibble
+// are counted with a lookup table and byte counts are summed with SAD.
+__attribute__((target("avx2")))
+static inline __m256i popcountAvx2(__m256i x, __m256i lookup, __m256i lowNibble) {
+    __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, lowNibble));
+    __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), lowNibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2")))
+static uint64_t nearestAvx2(vec r, const vec* codewords, size_t count) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    const __m256i received = _mm256_set1_epi64x(r);
+    const __m256i step = _mm256_set1_epi64x(8);
+    __m256i index0 = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i index1 = _mm256_setr_epi64x(4, 5, 6, 7);
+    __m256i best0 = _mm256_set1_epi64x(INT64_MAX);
+    __m256i best1 = best0;
+
+    // keys stay below 2^63, so signed comparison works
+    for (size_t i = 0; i < count; i += 8) {
+        __m256i c0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(codewords + i));
+        __m256i c1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(codewords + i + 4));
+        __m256i key0 = _mm256_or_si256(_mm256_slli_epi64(popcountAvx2(_mm256_xor_si256(c0, received), lookup, lowNibble), 32), index0);
+        __m256i key1 = _mm256_or_si256(_mm256_slli_epi64(popcountAvx2(_mm256_xor_si256(c1, received), lookup, lowNibble), 32), index1);
+        best0 = _mm256_blendv_epi8(best0, key0, _mm256_cmpgt_epi64(best0, key0));
+        best1 = _mm256_blendv_epi8(best1, key1, _mm256_cmpgt_epi64(best1, key1));
+        index0 = _mm256_add_epi64(index0, step);
+        index1 = _mm256_add_epi64(index1, step);
+    }
+    best0 = _mm256_blendv_epi8(best0, best1, _mm256_cmpgt_epi64(best0, best1));
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best0);
+    return *std::min_element(lanes, lanes + 4);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static uint64_t nearestAvx512(vec r, const vec* codewords, size_t count) {
+    const __m512i lookup = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+    const __m512i lowNibble = _mm512_set1_epi8(0x0F);
+    const __m512i received = _mm512_set1_epi64(r);
+    const __m512i step = _mm512_set1_epi64(8);
+    __m512i index = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    __m512i best = _mm512_set1_epi64(-1);
+
+    for (size_t i = 0; i < count; i += 8) {
+        __m512i x = _mm512_xor_si512(_mm512_load_si512(codewords + i), received);
+        __m512i low = _mm512_shuffle_epi8(lookup, _mm512_and_si512(x, lowNibble));
+        __m512i high = _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(x, 4), lowNibble));
+        __m512i distance = _mm512_sad_epu8(_mm512_add_epi8(low, high), _mm512_setzero_si512());
+        best = _mm512_min_epu64(best, _mm512_or_si512(_mm512_slli_epi64(distance, 32), index));
+        index = _mm512_add_epi64(index, step);
+    }
+    return _mm512_reduce_min_epu64(best);
+}
+
+#endif
+
+vec MlDecoder::decode(vec input, SimdLevel level) const {
+    decode({ &input, 1 }, { &input, 1 }, level);
+    return input;
+}
+
+void MlDecoder::decode(std::span<const vec> input, std::span<vec> output, SimdLevel level) const {
+    assert(input.size() == output.size());
+    const vec* codewords = m_codebook.data()->codewords;
+    size_t count = m_codebook.size() * 8;
+
+    if (level > detectSimdLevel()) level = detectSimdLevel();
+    auto nearest = nearestScalar;
+#ifdef ML_DECODER_X86
+    if (level == SimdLevel::avx512 && __builtin_cpu_supports("avx512bw")) nearest = nearestAvx512;
+    else if (level >= SimdLevel::avx2) nearest = nearestAvx2;
+#endif
+    for (size_t i = 0; i < input.size(); i++) {
+        // lower 32 bits of key hold the message
+        output[i] = nearest(input[i], codewords, count) & 0xFFFFFFFF;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <span>
+
+#include "math.h"
+#include "batchDecoder.h"
+
+// Largest code dimension k for which maximum likelihood decoding is offered (codebook has 2^k codewords).
+constexpr size_t mlDecoderMaxK = 16;
+
+// Maximum likelihood decoder: compares received vector with every codeword and returns message of a nearest one
+// (smallest Hamming distance). If several codewords are equally near, the one with the lowest message is picked,
+// while decode picks the one its coset leader gives, so on ties the two can return different messages.
+// Needs no syndrome table, but work grows as 2^k, so it only suits codes with small k.
+// Codewords are kept in a 64-byte aligned array, ordered by message, and distances are computed
+// with XOR + popcount, 4 codewords at a time with AVX2, 8 with AVX-512.
+class MlDecoder {
+public:
+    // Builds codebook of the code.
+    // args:
+    //   gTransposed - transposed generator matrix (n rows, k cols). k must be at most mlDecoderMaxK.
+    explicit MlDecoder(const matrix& gTransposed);
+
+    // Returns code length.
+    size_t n() const { return m_n; }
+
+    // Returns code dimension.
+    size_t k() const { return m_k; }
+
+    // Decodes input vector.
+    // args:
+    //   input - vector to decode, n bits.
+    //   level - instruction set to use. If CPU does not support it, a lower one is used.
+    // returns:
+    //   vec - message of the closest codeword, k bits.
+    vec decode(vec input, SimdLevel level = detectSimdLevel()) const;
+
+    // Decodes a batch of vectors.
+    // args:
+    //   input - vectors to decode.
+    //   output - decoded vectors. Must be the same size as input, can be the same span.
+    //   level - instruction set to use. If CPU does not support it, a lower one is used.
+    void decode(std::span<const vec> input, std::span<vec> output, SimdLevel level = detectSimdLevel()) const;
+
+private:
+    // one cache line of codewords
+    struct alignas(64) CodewordBlock {
+        vec codewords[8];
+    };
+
+    size_t m_n, m_k;
+    std::vector<CodewordBlock> m_codebook;
+};
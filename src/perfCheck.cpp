@@ -0,0 +1,208 @@
+#include "perfCheck.h"
+
+#include <print>
+#include <format>
+#include <vector>
+#include <string>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "math.h"
+#include "encoder.h"
+#include "channel.h"
+#include "batchDecoder.h"
+
+// workloads are the same on every run
+constexpr uint64_t workloadSeed = 42;
+constexpr size_t repetitions = 7;
+// short workloads are repeated within one repetition until it takes at least this long
+constexpr double minRepetitionMs = 20.0;
+// change must be bigger than this part of baseline and this many scaled MADs to count
+constexpr double relativeTolerance = 0.10;
+constexpr double noiseTolerance = 3.0;
+// MAD * 1.4826 estimates standard deviation of normally distributed noise
+constexpr double madScale = 1.4826;
+
+struct Measurement {
+    std::string kernel;
+    size_t n, k;
+    double medianNs, madNs; // time per item
+};
+
+// Returns median of values. Reorders values.
+static double median(std::vector<double>& values) {
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+// Runs workload several times, after one warm-up run that also decides how many times
+// workload is run in one repetition.
+// args:
+//   kernel - name of measured kernel.
+//   n, k - code parameters.
+//   items - number of items workload processes, time is reported per item.
+//   workload - callable that runs workload once and returns a checksum, so work isn't optimized away.
+// returns:
+//   Measurement - median and median absolute deviation of time per item.
+template <typename Fn>
+static Measurement measure(std::string_view kernel, size_t n, size_t k, size_t items, Fn&& workload) {
+    static volatile uint64_t sink;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    sink = sink + workload();
+    double warmUpMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    size_t runs = std::max<size_t>(1, static_cast<size_t>(std::ceil(minRepetitionMs / std::max(warmUpMs, 1e-3))));
+
+    std::vector<double> times;
+    for (size_t i = 0; i < repetitions; i++) {
+        begin = std::chrono::steady_clock::now();
+        for (size_t run = 0; run < runs; run++) sink = sink + workload();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::nano>(end - begin).count() / (items * runs));
+    }
+    double medianNs = median(times);
+    std::vector<double> deviations;
+    for (double t : times) deviations.push_back(std::abs(t - medianNs));
+    double madNs = median(deviations);
+    std::print("  {:>12} n={:<2} k={:<2} {:10.3f} ns ± {:.3f}\n", kernel, n, k, medianNs, madNs);
+    return { std::string(kernel), n, k, medianNs, madNs };
+}
+
+// Runs all workloads of one code.
+static void measureCode(size_t n, size_t k, std::vector<Measurement>& results) {
+    matrix g = matrix(k, k, true).append(randomMatrix(k, n - k, workloadSeed + n * 64 + k));
+    matrix gTransposed = g.transpose();
+    matrix h = calculateControlMatrix(g);
+
+    std::mt19937_64 generator(workloadSeed);
+    vec messageMask = (vec{1} << k) - 1;
+    std::vector<vec> messages(1 << 20), received(1 << 20), decoded(1 << 20);
+    Channel channel(workloadSeed);
+    for (size_t i = 0; i < messages.size(); i++) {
+        messages[i] = generator() & messageMask;
+        received[i] = channel.sendVector(encode(messages[i], gTransposed), n, 0.05);
+    }
+
+    Syndromes syndromes;
+    results.push_back(measure("syndromes", n, k, size_t{1} << (n - k), [&] {
+        syndromes = calculateSyndromes(h);
+        return syndromes.size();
+    }));
+    // same table layout the program decodes with
+    LocalSyndromeTable table = makeLocalSyndromeTable(syndromes, h);
+    matrix tableHTransposed = table.h.transpose();
+
+    results.push_back(measure("encode", n, k, messages.size(), [&] {
+        uint64_t sum = 0;
+        for (vec m : messages) sum += encode(m, gTransposed);
+        return sum;
+    }));
+    // one vector at a time, the way the program decodes single vectors
+    results.push_back(measure("decode", n, k, received.size(), [&] {
+        uint64_t sum = 0;
+        for (vec r : received) sum += decodeWithTable(r, table.table, tableHTransposed);
+        return sum;
+    }));
+    results.push_back(measure("decodeBatch", n, k, received.size(), [&] {
+        decodeBatch(received, decoded, table.table, table.h);
+        return decoded.back();
+    }));
+    results.push_back(measure("channel", n, k, messages.size(), [&] {
+        Channel c(workloadSeed);
+        uint64_t sum = 0;
+        for (vec m : messages) sum += c.sendVector(m, n, 0.05);
+        return sum;
+    }));
+
+    std::vector<uint8_t> data(1 << 22);
+    for (uint8_t& byte : data) byte = static_cast<uint8_t>(generator());
+    results.push_back(measure("packing", n, k, data.size(), [&] {
+        size_t lastVectorPadding = 0;
+        std::vector<vec> vectors = vectorsFromData(data, k, lastVectorPadding);
+        return vectorsToData(vectors, k, lastVectorPadding).size();
+    }));
+}
+
+// Reads baseline file.
+// returns:
+//   std::map - baseline measurements by "kernel n k".
+static std::map<std::string, Measurement> readBaseline(std::string_view path) {
+    std::map<std::string, Measurement> baseline;
+    std::ifstream file{ std::string(path) };
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        Measurement m;
+        if (fields >> m.kernel >> m.n >> m.k >> m.medianNs >> m.madNs) {
+            baseline[std::format("{} {} {}", m.kernel, m.n, m.k)] = m;
+        }
+    }
+    return baseline;
+}
+
+int runPerfCheck(std::string_view baselinePath, std::string_view summaryPath, bool updateBaseline) {
+    std::print("Vykdomi nasumo testai ({} kartojimai):\n", repetitions);
+    std::vector<Measurement> results;
+    for (auto [n, k] : { std::pair<size_t, size_t>{ 16, 8 }, { 24, 12 }, { 32, 16 } }) {
+        measureCode(n, k, results);
+    }
+
+    if (updateBaseline) {
+        std::ofstream file{ std::string(baselinePath) };
+        if (!file) {
+            std::print("Klaida! Nepavyko irasyti '{}'.\n", baselinePath);
+            return 1;
+        }
+        file << "# kernel n k median_ns_per_item mad_ns_per_item (machine specific, regenerate with make perfbaseline)\n";
+        for (const Measurement& m : results) file << std::format("{} {} {} {:.4f} {:.4f}\n", m.kernel, m.n, m.k, m.medianNs, m.madNs);
+        std::print("Baziniai rezultatai irasyti i '{}'\n", baselinePath);
+        return 0;
+    }
+
+    std::map<std::string, Measurement> baseline = readBaseline(baselinePath);
+    if (baseline.empty()) {
+        std::print("Klaida! Nepavyko nuskaityti baziniu rezultatu '{}'.\n", baselinePath);
+        return 1;
+    }
+
+    size_t regressions = 0, improvements = 0;
+    std::string entries;
+    std::print("\n  {:>12} {:>5} {:>12} {:>12} {:>8}  {}\n", "kernel", "n,k", "bazinis ns", "dabar ns", "greitis", "busena");
+    for (const Measurement& m : results) {
+        auto it = baseline.find(std::format("{} {} {}", m.kernel, m.n, m.k));
+        std::string status = "new";
+        double baselineNs = 0, speedup = 0;
+        if (it != baseline.end()) {
+            const Measurement& b = it->second;
+            baselineNs = b.medianNs;
+            speedup = b.medianNs / m.medianNs;
+            double noise = noiseTolerance * madScale * std::hypot(b.madNs, m.madNs);
+            double threshold = std::max(relativeTolerance * b.medianNs, noise);
+            double change = m.medianNs - b.medianNs;
+            status = change > threshold ? "regression" : (-change > threshold ? "improvement" : "unchanged");
+            regressions += status == "regression";
+            improvements += status == "improvement";
+        }
+        std::print("  {:>12} {:>5} {:>12.3f} {:>12.3f} {:>7.2f}x  {}\n", m.kernel, std::format("{},{}", m.n, m.k), baselineNs, m.medianNs, speedup, status);
+        entries += std::format("{}    {{\"kernel\": \"{}\", \"n\": {}, \"k\": {}, \"baseline_ns\": {:.4f}, \"median_ns\": {:.4f}, "
+                               "\"mad_ns\": {:.4f}, \"speedup\": {:.4f}, \"status\": \"{}\"}}",
+                               entries.empty() ? "" : ",\n", m.kernel, m.n, m.k, baselineNs, m.medianNs, m.madNs, speedup, status);
+    }
+
+    std::ofstream summary{ std::string(summaryPath) };
+    summary << std::format("{{\n  \"repetitions\": {},\n  \"regressions\": {},\n  \"improvements\": {},\n  \"results\": [\n{}\n  ]\n}}\n",
+                           repetitions, regressions, improvements, entries);
+    summary.close(); // write errors show up on flush
+    if (!summary) {
+        std::print("Klaida! Nepavyko irasyti '{}'.\n", summaryPath);
+        return 1;
+    }
+    std::print("Suletejo: {}, pagreitejo: {}. Santrauka irasyta i '{}'\n", regressions, improvements, summaryPath);
+    return regressions == 0 ? 0 : 1;
+}
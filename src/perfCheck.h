@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string_view>
+
+// Default files used by 'make perfcheck'.
+constexpr std::string_view defaultPerfBaselinePath = "perf/baseline.txt";
+constexpr std::string_view defaultPerfSummaryPath = "perfcheck.json";
+
+// Runs fixed, seeded workloads (syndrome generation, encoding, decoding, batch decoding, channel, packing)
+// for several (n, k), several times each, and compares median time per item with the baseline file.
+// A kernel counts as slower or faster only if the change exceeds both a relative tolerance and
+// the noise of both measurements (scaled median absolute deviation), so noisy runs don't fail.
+// Results are printed and written as JSON to summary file.
+// args:
+//   baselinePath - file with baseline results. Lines are "<kernel> <n> <k> <median ns> <mad ns>".
+//   summaryPath - file to write JSON summary to.
+//   updateBaseline - if true, baseline file is overwritten with current results instead of comparing.
+// returns:
+//   int - exit code: 0 if nothing got slower, 1 if some kernel got slower or files could not be used.
+int runPerfCheck(std::string_view baselinePath, std::string_view summaryPath, bool updateBaseline);
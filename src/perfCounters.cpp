@@ -0,0 +1,116 @@
+#include "perfCounters.h"
+
+#include <print>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+void PerfCounterValues::add(const PerfCounterValues& other) {
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i] && other.values[i]) *values[i] += *other.values[i];
+        else values[i].reset();
+    }
+}
+
+#ifdef __linux__
+
+// Opens one counter for the calling thread, user space only.
+// returns:
+//   int - file descriptor of counter, -1 if it can't be opened.
+static int openCounter(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+PerfCounters::PerfCounters() {
+    constexpr uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    m_fds[static_cast<size_t>(PerfEvent::cycles)] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    m_fds[static_cast<size_t>(PerfEvent::instructions)] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    m_fds[static_cast<size_t>(PerfEvent::l1dMisses)] = openCounter(PERF_TYPE_HW_CACHE, l1dReadMiss);
+    m_fds[static_cast<size_t>(PerfEvent::llcMisses)] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    m_fds[static_cast<size_t>(PerfEvent::branchMisses)] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : m_fds) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+void PerfCounters::start() {
+    for (int fd : m_fds) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+PerfCounterValues PerfCounters::stop() {
+    PerfCounterValues result;
+    for (size_t i = 0; i < m_fds.size(); i++) {
+        if (m_fds[i] < 0) continue;
+        ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        // value, time enabled, time running
+        uint64_t data[3];
+        if (read(m_fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0) continue;
+        // if more counters are open than the CPU has, kernel multiplexes them, so value is scaled to whole time
+        result.values[i] = data[2] == data[1] ? data[0] : static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+    }
+    return result;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    m_fds.fill(-1);
+}
+PerfCounters::~PerfCounters() {}
+void PerfCounters::start() {}
+PerfCounterValues PerfCounters::stop() {
+    return {};
+}
+
+#endif
+
+bool PerfCounters::available() const {
+    for (int fd : m_fds) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+void printPerfCounters(std::string_view label, const PerfCounterValues& values, size_t ops) {
+    auto perOp = [&](PerfEvent event) -> std::string {
+        std::optional<uint64_t> value = values.get(event);
+        if (!value || ops == 0) return "n/a";
+        return std::format("{:.2f}", static_cast<double>(*value) / ops);
+    };
+    auto ratio = [&](PerfEvent numerator, PerfEvent denominator) -> std::string {
+        std::optional<uint64_t> a = values.get(numerator);
+        std::optional<uint64_t> b = values.get(denominator);
+        if (!a || !b || *b == 0) return "n/a";
+        return std::format("{:.3f}", static_cast<double>(*a) / *b);
+    };
+
+    bool any = false;
+    for (const auto& value : values.values) any |= value.has_value();
+    if (!any) return;
+
+    std::print("  {} per op: cycles {}, instructions {}, IPC {}, L1D misses {}, LLC misses {}, branch misses {}\n", label,
+               perOp(PerfEvent::cycles), perOp(PerfEvent::instructions), ratio(PerfEvent::instructions, PerfEvent::cycles),
+               perOp(PerfEvent::l1dMisses), perOp(PerfEvent::llcMisses), perOp(PerfEvent::branchMisses));
+}
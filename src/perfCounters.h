@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <optional>
+#include <string_view>
+
+// Hardware events that PerfCounters can count.
+enum class PerfEvent {
+    cycles,
+    instructions,
+    l1dMisses,
+    llcMisses,
+    branchMisses,
+    count, // number of events, not an event
+};
+
+// Values of hardware counters read over a measured region.
+// Counter that could not be opened has no value.
+struct PerfCounterValues {
+    std::array<std::optional<uint64_t>, static_cast<size_t>(PerfEvent::count)> values;
+
+    // Returns value of counter.
+    // args:
+    //   event - event to get value of.
+    // returns:
+    //   std::optional<uint64_t> - counter value, empty if counter is not available.
+    std::optional<uint64_t> get(PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+
+    // Adds values of other region to this one.
+    // args:
+    //   other - values to add.
+    void add(const PerfCounterValues& other);
+};
+
+// Reads Linux hardware performance counters (perf_event_open) of the calling thread.
+// If counters are not available (other OS, no permission, virtual machine without PMU),
+// everything still works, but values are empty.
+class PerfCounters {
+public:
+    // Opens counters. They are not running until start() is called.
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Returns true if at least one counter could be opened.
+    // returns:
+    //   bool - true if counters are available.
+    bool available() const;
+
+    // Resets and starts counters.
+    void start();
+
+    // Stops counters and returns values counted since start().
+    // returns:
+    //   PerfCounterValues - counted values.
+    PerfCounterValues stop();
+
+private:
+    std::array<int, static_cast<size_t>(PerfEvent::count)> m_fds;
+};
+
+// Prints counter values per operation: cycles, instructions, IPC and miss rates.
+// Prints nothing if no counter is available.
+// args:
+//   label - name of measured region.
+//   values - counter values of region.
+//   ops - number of operations done in region (e.g. decoded vectors).
+void printPerfCounters(std::string_view label, const PerfCounterValues& values, size_t ops);
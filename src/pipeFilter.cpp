@@ -0,0 +1,388 @@
+#include "pipeFilter.h"
+
+#include <print>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <algorithm>
+
+#include "io.h"
+#include "channel.h"
+#include "autotune.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+// Vectors are processed in chunks of this many blocks. Block is 8 vectors, so it is k bytes
+// of message and n bytes of encoded stream, and every full chunk is a whole number of bytes on both sides.
+constexpr size_t blocksPerChunk = 16384;
+
+// Size of encoded stream trailer: padding bits of stream, padding bits of last message vector.
+constexpr size_t trailerSize = 2;
+
+struct FilterArgs {
+    size_t n = 0, k = 0;
+    std::string matrixPath;
+    std::optional<uint64_t> seed;
+    std::optional<double> p;
+    size_t tableBudget = defaultFullDecodeTableBudget; // bytes
+    std::string tableCache; // directory of cached full decode tables, empty if tables are not cached
+};
+
+// Parses number from command line argument.
+// template args:
+//   T - type of number.
+// args:
+//   text - argument.
+//   result - gets set to parsed number.
+// returns:
+//   bool - true if whole argument is a number.
+template <typename T>
+static bool parseNumber(std::string_view text, T& result) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+// Parses flags of subcommand (everything after argv[1]).
+// args:
+//   argc - number of command line arguments.
+//   argv - command line arguments.
+//   args - gets set to parsed flags.
+// returns:
+//   bool - true if all flags are known and have valid values.
+static bool parseArgs(int argc, char** argv, FilterArgs& args) {
+    for (int i = 2; i < argc; i++) {
+        std::string_view flag = argv[i];
+        if (i + 1 >= argc) {
+            std::print(stderr, "Klaida! Nenurodyta '{}' reiksme.\n", flag);
+            return false;
+        }
+        std::string_view value = argv[++i];
+        bool valid = true;
+        if (flag == "-n") valid = parseNumber(value, args.n);
+        else if (flag == "-k") valid = parseNumber(value, args.k);
+        else if (flag == "-g") args.matrixPath = value;
+        else if (flag == "--seed") valid = parseNumber(value, args.seed.emplace());
+        else if (flag == "--table-budget") {
+            size_t mebibytes = 0;
+            valid = parseNumber(value, mebibytes) && mebibytes <= (SIZE_MAX >> 20);
+            args.tableBudget = mebibytes << 20;
+        }
+        else if (flag == "--table-cache") args.tableCache = value;
+        else if (flag == "-p") valid = parseNumber(value, args.p.emplace()) && *args.p >= 0.0 && *args.p <= 1.0;
+        else {
+            std::print(stderr, "Klaida! Nezinomas parametras '{}'.\n", flag);
+            return false;
+        }
+        if (!valid) {
+            std::print(stderr, "Klaida! Netinkama '{}' reiksme '{}'.\n", flag, value);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads part A of generator matrix from file. Lines are rows of zeros and ones,
+// either n-k long (part A) or n long (whole G, first k columns must be identity matrix).
+// args:
+//   path - file to read.
+//   n - code length.
+//   k - code dimension.
+//   a - gets set to part A of generator matrix.
+// returns:
+//   bool - true if file has a valid matrix.
+static bool readMatrixA(const std::string& path, size_t n, size_t k, matrix& a) {
+    std::ifstream file(path);
+    if (!file) {
+        std::print(stderr, "Klaida! Nepavyko atidaryti failo '{}'.\n", path);
+        return false;
+    }
+    a = matrix(k, n - k);
+    std::string line;
+    size_t row = 0;
+    while (std::getline(file, line)) {
+        std::erase_if(line, [](char c) { return c == ' ' || c == '\t' || c == '\r'; });
+        if (line.empty()) continue;
+        if (row == k || (line.size() != n - k && line.size() != n) || line.find_first_not_of("01") != std::string::npos) {
+            std::print(stderr, "Klaida! Faile '{}' turi buti {} eilutes is {} arba {} nuliu ir vienetu. (eilute {})\n", path, k, n - k, n, row + 1);
+            return false;
+        }
+        size_t offset = line.size() - (n - k);
+        for (size_t col = 0; col < offset; col++) {
+            if (line[col] - '0' != (col == row)) {
+                std::print(stderr, "Klaida! Pirmi {} matricos G stulpeliai turi sudaryti vienetine matrica. (eilute {})\n", k, row + 1);
+                return false;
+            }
+        }
+        for (size_t col = 0; col < n - k; col++) a.setVal(row, col, line[offset + col] - '0');
+        row++;
+    }
+    if (row != k) {
+        std::print(stderr, "Klaida! Faile '{}' turi buti {} eilutes, rasta {}.\n", path, k, row);
+        return false;
+    }
+    return true;
+}
+
+// Builds code parameters from flags.
+// args:
+//   args - parsed flags.
+//   withSyndromes - generate syndromes (needed only for decoding). Waits until they are generated.
+//   params - gets set to code parameters.
+// returns:
+//   bool - true if flags describe a valid code.
+static bool makeFilterParams(const FilterArgs& args, bool withSyndromes, CommonParams& params) {
+    if (args.n < 2 || args.n > 64 || args.k < 1 || args.k >= args.n) {
+        std::print(stderr, "Klaida! Reikia nurodyti -n [2;64] ir -k [1;n-1].\n");
+        return false;
+    }
+    // syndrome table has 2^(n-k) entries, bigger ones don't fit into memory
+    if (withSyndromes && args.n - args.k > maxSyndromeBits) {
+        std::print(stderr, "Klaida! Dekoduojant n-k turi buti ne daugiau {}.\n", maxSyndromeBits);
+        return false;
+    }
+    if (args.matrixPath.empty() == !args.seed.has_value()) {
+        std::print(stderr, "Klaida! Reikia nurodyti arba -g failas, arba --seed skaicius.\n");
+        return false;
+    }
+    matrix a;
+    if (args.seed) a = randomMatrix(args.k, args.n - args.k, *args.seed);
+    else if (!readMatrixA(args.matrixPath, args.n, args.k, a)) return false;
+
+    if (withSyndromes) {
+        params = makeCommonParams(args.n, args.k, a);
+        return true;
+    }
+    params = CommonParams();
+    params.n = args.n;
+    params.k = args.k;
+    params.g = matrix(args.k, args.k, true).append(a);
+    params.gTransposed = params.g.transpose();
+    params.h = calculateControlMatrix(params.g);
+    return true;
+}
+
+// Unpacks vectors of vecSize bits from bytes, most significant bit first. Missing bits after end of data are zeros.
+// template args:
+//   T - word vectors are stored in.
+// args:
+//   data - bytes to unpack.
+//   vecSize - size of each vector in bits.
+//   vectors - gets set to unpacked vectors, its size is number of vectors to unpack.
+template <VectorWord T>
+static void unpackVectors(std::span<const uint8_t> data, size_t vecSize, std::span<T> vectors) {
+    uint64_t bits = 0; // unused bits are the lowest 'bitCount' bits
+    size_t bitCount = 0;
+    size_t offset = 0;
+    for (T& v : vectors) {
+        vec value = 0;
+        // at most 32 bits at a time, so buffered bits never overflow
+        for (size_t remaining = vecSize; remaining > 0;) {
+            size_t take = std::min<size_t>(remaining, 32);
+            while (bitCount < take) {
+                bits = (bits << 8) | (offset < data.size() ? data[offset] : 0);
+                offset++;
+                bitCount += 8;
+            }
+            bitCount -= take;
+            value = (value << take) | ((bits >> bitCount) & ((uint64_t{1} << take) - 1));
+            remaining -= take;
+        }
+        v = static_cast<T>(value);
+    }
+}
+
+// Packs vectors of vecSize bits to bytes, most significant bit first. Last byte is padded with zeros.
+// template args:
+//   T - word vectors are stored in.
+// args:
+//   vectors - vectors to pack.
+//   vecSize - size of each vector in bits.
+//   data - gets set to packed bytes, must have at least ceil(vectors.size() * vecSize / 8) bytes.
+// returns:
+//   size_t - number of bytes written.
+template <VectorWord T>
+static size_t packVectors(std::span<const T> vectors, size_t vecSize, std::span<uint8_t> data) {
+    uint64_t bits = 0; // bits not written yet are the lowest 'bitCount' bits
+    size_t bitCount = 0;
+    size_t offset = 0;
+    for (vec v : vectors) {
+        for (size_t remaining = vecSize; remaining > 0;) {
+            size_t put = std::min<size_t>(remaining, 32);
+            remaining -= put;
+            bits = (bits << put) | ((v >> remaining) & ((uint64_t{1} << put) - 1));
+            bitCount += put;
+            while (bitCount >= 8) {
+                bitCount -= 8;
+                data[offset++] = static_cast<uint8_t>(bits >> bitCount);
+            }
+        }
+    }
+    if (bitCount > 0) data[offset++] = static_cast<uint8_t>(bits << (8 - bitCount));
+    return offset;
+}
+
+// Writes all bytes to stdout.
+// args:
+//   data - bytes to write.
+// returns:
+//   bool - true on success.
+static bool writeOutput(std::span<const uint8_t> data) {
+    if (std::fwrite(data.data(), 1, data.size(), stdout) == data.size()) return true;
+    std::print(stderr, "Klaida! Nepavyko rasyti i standartine isvesti.\n");
+    return false;
+}
+
+// Reads stdin in chunks through one reusable buffer. Last 'keepSize' bytes of stream are never part of a chunk,
+// so a trailer can be handled separately.
+// args:
+//   chunkSize - size of full chunk in bytes.
+//   keepSize - number of bytes at the end of stream to hold back.
+//   fullChunk - called with every full chunk, returns false to stop.
+//   lastChunk - called once at the end of stream with the rest of stream (shorter than a full chunk) and held back bytes.
+// returns:
+//   bool - false if stream is shorter than keepSize, could not be read, or a callback returned false.
+template <typename FullChunk, typename LastChunk>
+static bool readChunks(size_t chunkSize, size_t keepSize, FullChunk&& fullChunk, LastChunk&& lastChunk) {
+    std::vector<uint8_t> buffer(chunkSize + keepSize);
+    size_t filled = 0;
+    while (true) {
+        filled += std::fread(buffer.data() + filled, 1, buffer.size() - filled, stdin);
+        if (filled < buffer.size()) break;
+        if (!fullChunk(std::span<uint8_t>(buffer.data(), chunkSize))) return false;
+        std::memmove(buffer.data(), buffer.data() + chunkSize, keepSize);
+        filled = keepSize;
+    }
+    if (std::ferror(stdin)) {
+        std::print(stderr, "Klaida! Nepavyko skaityti standartines ivesties.\n");
+        return false;
+    }
+    if (filled < keepSize) {
+        std::print(stderr, "Klaida! Uzkoduotas srautas per trumpas.\n");
+        return false;
+    }
+    return lastChunk(std::span<uint8_t>(buffer.data(), filled - keepSize), std::span<uint8_t>(buffer.data() + filled - keepSize, keepSize));
+}
+
+// Encodes message bytes from stdin and writes encoded stream to stdout.
+// template args:
+//   T - word vectors are stored in, must have at least n bits.
+// args:
+//   params - code parameters.
+// returns:
+//   int - exit code.
+template <VectorWord T>
+static int encodeFilter(const CommonParams& params) {
+    std::vector<T> vectors(blocksPerChunk * 8);
+    std::vector<uint8_t> output(blocksPerChunk * params.n);
+
+    auto encodeChunk = [&](std::span<const uint8_t> input, size_t vectorCount) {
+        std::span<T> chunk(vectors.data(), vectorCount);
+        unpackVectors<T>(input, params.k, chunk);
+        encodeVectors<T>(chunk, params);
+        return packVectors<T>(chunk, params.n, output);
+    };
+    bool ok = readChunks(blocksPerChunk * params.k, 0, [&](std::span<uint8_t> input) {
+        return writeOutput(std::span(output.data(), encodeChunk(input, vectors.size())));
+    }, [&](std::span<uint8_t> input, std::span<uint8_t>) {
+        size_t vectorCount = (input.size() * 8 + params.k - 1) / params.k;
+        size_t size = encodeChunk(input, vectorCount);
+        uint8_t trailer[trailerSize] = {
+            static_cast<uint8_t>(size * 8 - vectorCount * params.n),
+            static_cast<uint8_t>(vectorPadding(input.size(), params.k)),
+        };
+        return writeOutput(std::span(output.data(), size)) && writeOutput(trailer);
+    });
+    return ok && std::fflush(stdout) == 0 ? 0 : 1;
+}
+
+// Decodes encoded stream from stdin and writes message bytes to stdout.
+// template args:
+//   T - word vectors are stored in, must have at least n bits.
+// args:
+//   params - code parameters, with syndromes.
+// returns:
+//   int - exit code.
+template <VectorWord T>
+static int decodeFilter(const CommonParams& params) {
+    std::vector<T> vectors(blocksPerChunk * 8);
+    std::vector<uint8_t> output(blocksPerChunk * params.k);
+
+    auto decodeChunk = [&](std::span<const uint8_t> input, size_t vectorCount) {
+        std::span<T> chunk(vectors.data(), vectorCount);
+        unpackVectors<T>(input, params.n, chunk);
+        decodeVectors<T>(chunk, params);
+        return packVectors<T>(chunk, params.k, output);
+    };
+    bool ok = readChunks(blocksPerChunk * params.n, trailerSize, [&](std::span<uint8_t> input) {
+        return writeOutput(std::span(output.data(), decodeChunk(input, vectors.size())));
+    }, [&](std::span<uint8_t> input, std::span<uint8_t> trailer) {
+        size_t streamPadding = trailer[0];
+        size_t messagePadding = trailer[1];
+        size_t bitCount = input.size() * 8;
+        if (streamPadding >= 8 || streamPadding > bitCount || (bitCount - streamPadding) % params.n != 0) {
+            std::print(stderr, "Klaida! Uzkoduoto srauto ilgis netinka kodui (n={}).\n", params.n);
+            return false;
+        }
+        size_t vectorCount = (bitCount - streamPadding) / params.n;
+        if (messagePadding >= params.k || messagePadding > vectorCount * params.k || (vectorCount * params.k - messagePadding) % 8 != 0) {
+            std::print(stderr, "Klaida! Netinkama uzkoduoto srauto pabaiga.\n");
+            return false;
+        }
+        decodeChunk(input, vectorCount);
+        return writeOutput(std::span(output.data(), (vectorCount * params.k - messagePadding) / 8));
+    });
+    return ok && std::fflush(stdout) == 0 ? 0 : 1;
+}
+
+// Sends encoded stream from stdin through channel and writes it to stdout. Trailer is not modified.
+// args:
+//   p - probability of errors.
+//   seed - seed of channel errors, random if not given.
+// returns:
+//   int - exit code.
+static int channelFilter(double p, std::optional<uint64_t> seed) {
+    Channel channel = seed ? Channel(*seed) : Channel();
+    bool ok = readChunks(blocksPerChunk * 64, trailerSize, [&](std::span<uint8_t> input) {
+        channel.sendBytes(input, p);
+        return writeOutput(input);
+    }, [&](std::span<uint8_t> input, std::span<uint8_t> trailer) {
+        channel.sendBytes(input, p);
+        return writeOutput(input) && writeOutput(trailer);
+    });
+    return ok && std::fflush(stdout) == 0 ? 0 : 1;
+}
+
+int runPipeFilter(int argc, char** argv) {
+    std::string_view command = argv[1];
+    FilterArgs args;
+    if (!parseArgs(argc, argv, args)) return 1;
+
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    if (command == "channel") {
+        if (!args.p) {
+            std::print(stderr, "Klaida! Reikia nurodyti klaidos tikimybe -p [0;1].\n");
+            return 1;
+        }
+        return channelFilter(*args.p, args.seed);
+    }
+
+    CommonParams params;
+    if (!makeFilterParams(args, command == "decode", params)) return 1;
+    if (command == "decode") useFullDecodeTable(params, args.tableBudget, args.tableCache);
+    return withVectorWord(params.n, [&]<VectorWord T>() {
+        return command == "decode" ? decodeFilter<T>(params) : encodeFilter<T>(params);
+    });
+}
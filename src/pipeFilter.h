@@ -0,0 +1,28 @@
+#pragma once
+
+// Pipe-filter mode reads raw bytes from stdin and writes raw bytes to stdout without any prompts,
+// so the program can be used in pipelines, e.g.
+//   program encode -n 24 -k 12 --seed 7 < in | program channel -p 0.01 | program decode -n 24 -k 12 --seed 7 > out
+//
+// Subcommands:
+//   encode  -n N -k K (-g FILE | --seed S)   message bytes -> encoded stream
+//   channel -p P [--seed S]                  encoded stream -> encoded stream with bits flipped with probability P
+//   decode  -n N -k K (-g FILE | --seed S) [--table-budget MIB] [--table-cache DIR]   encoded stream -> message bytes
+// Code is given by a file with part A of generator matrix G = [I|A] (k lines of n-k zeros and ones, same as interactive input,
+// full rows of G are accepted too) or by a seed of random part A. encode and decode must get the same code.
+// decode needs a syndrome table of 2^(n-k) entries, so n-k can be at most maxSyndromeBits (32).
+// decode uses full decode table if it takes at most --table-budget MiB (16 by default, 0 disables it).
+// With --table-cache the table is saved to DIR and mapped from there next time instead of being built again.
+//
+// Encoded stream is the message split into k-bit vectors, each encoded into n bits, with bits packed back to back
+// (most significant first) and zero padded to a whole byte. It ends with a 2 byte trailer:
+// number of padding bits at the end of the stream and number of padding bits in the last message vector.
+// channel does not modify the trailer.
+
+// Runs pipe-filter subcommand.
+// args:
+//   argc - number of command line arguments.
+//   argv - command line arguments, argv[1] is the subcommand.
+// returns:
+//   int - exit code: 0 on success, 1 if arguments are invalid or stream could not be read or written.
+int runPipeFilter(int argc, char** argv);
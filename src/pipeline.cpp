@@ -0,0 +1,140 @@
+#include "pipeline.h"
+
+#include <thread>
+#include <chrono>
+#include <numeric>
+#include <print>
+
+#include "spscQueue.h"
+#include "channel.h"
+#include "math.h"
+#include "encoder.h"
+
+// Block of vectors passed between pipeline stages.
+struct VectorBlock {
+    std::vector<vec> vectors;
+    size_t lastVectorPadding = 0; // only set in last block
+    bool last = false;
+};
+
+using BlockQueue = SpscQueue<VectorBlock>;
+using Clock = std::chrono::steady_clock;
+
+static double millisecondsBetween(Clock::time_point begin, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// Runs a stage that takes blocks from one queue, modifies vectors and passes blocks to the next queue.
+// args:
+//   in - queue to take blocks from.
+//   out - queue to pass blocks to.
+//   stats - statistics of this stage.
+//   process - callable that modifies vectors of a block.
+template <typename ProcessFn>
+static void runStage(BlockQueue& in, BlockQueue& out, StageStats& stats, ProcessFn&& process) {
+    size_t occupancySum = 0;
+    bool last = false;
+    while (!last) {
+        Clock::time_point waitBegin = Clock::now();
+        occupancySum += in.size();
+        VectorBlock block = in.pop();
+        Clock::time_point busyBegin = Clock::now();
+        process(block.vectors);
+        Clock::time_point busyEnd = Clock::now();
+        last = block.last;
+        out.push(std::move(block));
+
+        stats.waitMs += millisecondsBetween(waitBegin, busyBegin) + millisecondsBetween(busyEnd, Clock::now());
+        stats.busyMs += millisecondsBetween(busyBegin, busyEnd);
+        stats.blocks++;
+    }
+    stats.averageOccupancy = static_cast<double>(occupancySum) / stats.blocks;
+}
+
+std::vector<uint8_t> runPipeline(std::span<const uint8_t> data, const CommonParams& params, double p, PipelineStats& stats,
+                                 size_t blockVectors, size_t queueCapacity) {
+    stats = {};
+    stats.stages[0].name = "pack";
+    stats.stages[1].name = "encode";
+    stats.stages[2].name = "channel";
+    stats.stages[3].name = "decode";
+    stats.stages[4].name = "unpack";
+    BlockQueue packed(queueCapacity), encoded(queueCapacity), sent(queueCapacity), decoded(queueCapacity);
+    stats.queueCapacity = packed.capacity();
+
+    // every block except the last must hold whole bytes, so data is cut into chunks of lcm(8, k) bits
+    size_t unitBytes = params.k / std::gcd(params.k, size_t{8});
+    size_t unitVectors = 8 / std::gcd(params.k, size_t{8});
+    size_t chunkBytes = unitBytes * std::max<size_t>(blockVectors / unitVectors, 1);
+
+    std::vector<uint8_t> result;
+    result.reserve(data.size());
+    Clock::time_point begin = Clock::now();
+    {
+        std::jthread packThread([&] {
+            StageStats& st = stats.stages[0];
+            size_t offset = 0;
+            bool last = false;
+            while (!last) {
+                Clock::time_point busyBegin = Clock::now();
+                size_t size = std::min(chunkBytes, data.size() - offset);
+                last = offset + size == data.size();
+                VectorBlock block;
+                block.vectors = vectorsFromData(data.subspan(offset, size), params.k, block.lastVectorPadding);
+                block.last = last;
+                offset += size;
+                Clock::time_point busyEnd = Clock::now();
+                packed.push(std::move(block));
+
+                st.busyMs += millisecondsBetween(busyBegin, busyEnd);
+                st.waitMs += millisecondsBetween(busyEnd, Clock::now());
+                st.blocks++;
+            }
+        });
+        std::jthread encodeThread([&] {
+            runStage(packed, encoded, stats.stages[1], [&](std::vector<vec>& vectors) {
+                for (vec& v : vectors) v = encode(v, params);
+            });
+        });
+        std::jthread channelThread([&] {
+            Channel channel;
+            runStage(encoded, sent, stats.stages[2], [&](std::vector<vec>& vectors) {
+                for (vec& v : vectors) v = channel.sendVector(v, params.n, p);
+            });
+        });
+        std::jthread decodeThread([&] {
+            runStage(sent, decoded, stats.stages[3], [&](std::vector<vec>& vectors) {
+                decodeVectors(vectors, params);
+            });
+        });
+        std::jthread unpackThread([&] {
+            StageStats& st = stats.stages[4];
+            size_t occupancySum = 0;
+            bool last = false;
+            while (!last) {
+                Clock::time_point waitBegin = Clock::now();
+                occupancySum += decoded.size();
+                VectorBlock block = decoded.pop();
+                Clock::time_point busyBegin = Clock::now();
+                std::vector<uint8_t> bytes = vectorsToData(block.vectors, params.k, block.lastVectorPadding);
+                result.insert(result.end(), bytes.begin(), bytes.end());
+                last = block.last;
+
+                st.waitMs += millisecondsBetween(waitBegin, busyBegin);
+                st.busyMs += millisecondsBetween(busyBegin, Clock::now());
+                st.blocks++;
+            }
+            st.averageOccupancy = static_cast<double>(occupancySum) / st.blocks;
+        });
+    }
+    stats.totalMs = millisecondsBetween(begin, Clock::now());
+    return result;
+}
+
+void printPipelineStats(const PipelineStats& stats) {
+    std::print("Konvejeris baige darba per {:.2f}ms (eiles talpa {} blokai):\n", stats.totalMs, stats.queueCapacity);
+    std::print("  {:>8} | {:>6} | {:>10} | {:>10} | {:>8}\n", "etapas", "blokai", "darbas ms", "laukimas ms", "eile");
+    for (const StageStats& st : stats.stages) {
+        std::print("  {:>8} | {:>6} | {:>10.2f} | {:>10.2f} | {:>8.2f}\n", st.name, st.blocks, st.busyMs, st.waitMs, st.averageOccupancy);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <string_view>
+
+#include "io.h"
+
+// Statistics of one pipeline stage.
+struct StageStats {
+    std::string_view name;
+    double busyMs = 0; // time spent processing blocks
+    double waitMs = 0; // time spent waiting for input or for space in output queue
+    size_t blocks = 0; // number of processed blocks
+    double averageOccupancy = 0; // average number of blocks waiting in stage input queue
+};
+
+// Statistics of whole pipeline run.
+struct PipelineStats {
+    std::array<StageStats, 5> stages; // pack, encode, channel, decode, unpack
+    size_t queueCapacity = 0;
+    double totalMs = 0;
+};
+
+// Sends data through channel with encoding, running every stage (pack -> encode -> channel -> decode -> unpack)
+// on its own thread. Stages exchange blocks of vectors through bounded lock-free queues,
+// so a stage waits if the next one can't keep up.
+// args:
+//   data - bytes to send.
+//   params - common parameters.
+//   p - probability of errors.
+//   stats - gets set to statistics of every stage.
+//   blockVectors - approximate number of vectors in one block.
+//   queueCapacity - maximum number of blocks waiting between two stages.
+// returns:
+//   std::vector<uint8_t> - received and decoded bytes.
+std::vector<uint8_t> runPipeline(std::span<const uint8_t> data, const CommonParams& params, double p, PipelineStats& stats,
+                                 size_t blockVectors = 4096, size_t queueCapacity = 8);
+
+// Prints pipeline statistics.
+// args:
+//   stats - statistics to print.
+void printPipelineStats(const PipelineStats& stats);
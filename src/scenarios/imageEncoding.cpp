@@ -10,6 +10,39 @@
 #include "../channel.h"
 #include "../math.h"
 #include "../encoder.h"
+#include "../pipeline.h"
+
+// Sends data through channel without encoding.
+// template args:
+//   T - word vectors are stored in, must have at least k bits.
+// returns:
+//   std::vector<uint8_t> - received data.
+template <VectorWord T>
+static std::vector<uint8_t> sendUnencoded(std::span<const uint8_t> data, const CommonParams& params, double p, Channel& channel) {
+    size_t lastVectorPadding = 0;
+    std::vector<T> vectors = vectorsFromData<T>(data, params.k, lastVectorPadding);
+    for (auto& v : vectors) {
+        v = static_cast<T>(channel.sendVector(v, params.k, p));
+    }
+    return vectorsToData<T>(vectors, params.k, lastVectorPadding);
+}
+
+// Encodes data, sends it through channel and decodes it. All steps work on the same buffer.
+// template args:
+//   T - word vectors are stored in, must have at least n bits.
+// returns:
+//   std::vector<uint8_t> - decoded data.
+template <VectorWord T>
+static std::vector<uint8_t> sendEncoded(std::span<const uint8_t> data, const CommonParams& params, double p, Channel& channel) {
+    size_t lastVectorPadding = 0;
+    std::vector<T> vectors = vectorsFromData<T>(data, params.k, lastVectorPadding);
+    encodeVectors<T>(vectors, params);
+    for (auto& v : vectors) {
+        v = static_cast<T>(channel.sendVector(v, params.n, p));
+    }
+    decodeVectors<T>(vectors, params);
+    return vectorsToData<T>(vectors, params.k, lastVectorPadding);
+}
 
 void imageEncodingStart(const CommonParams& params) {
     double p = userInputNumber<double>("Iveskite klaidos tikimybe p: ", 0.0, 1.0);
@@ -24,35 +57,23 @@ void imageEncodingStart(const CommonParams& params) {
         return;
     }
 
-    // split image into vectors
+    // vectors are stored in the narrowest word that holds n bits
     std::span<const uint8_t> imageSpan(imageData, width * height * channels);
-    size_t lastVectorPadding = 0;
-    std::vector<vec> originalVectors = vectorsFromData(imageSpan, params.k, lastVectorPadding);
-    stbi_image_free(imageData);
+    std::vector<uint8_t> unencodedData = withVectorWord(params.n, [&]<VectorWord T>() {
+        return sendUnencoded<T>(imageSpan, params, p, channel);
+    });
 
-    // send throught channel original vectors
-    std::vector<vec> receivedUnencodedVectors = originalVectors;
-    for (auto& v : receivedUnencodedVectors) {
-        v = channel.sendVector(v, params.k, p);
-    }
-
-    // encode vectors
-    std::vector<vec> encodedVectors = originalVectors;
-    for (auto& v : encodedVectors) {
-        v = encode(v, params.gTransposed);
-    }
-
-    // send through channel encoded vectors
-    std::vector<vec> receivedEncodedVectors = encodedVectors;
-    for (auto& v : receivedEncodedVectors) {
-        v = channel.sendVector(v, params.n, p);
-    }
-
-    // decode received vectors
-    std::vector<vec> decodedVectors = receivedEncodedVectors;
-    for (auto& v : decodedVectors) {
-        v = decode(v, params.syndromes, params.h);
+    std::vector<uint8_t> encodedData;
+    if (userInputChoice("Ar naudoti konvejerini vykdyma (kiekvienas etapas atskiroje gijoje)?")) {
+        PipelineStats stats;
+        encodedData = runPipeline(imageSpan, params, p, stats);
+        printPipelineStats(stats);
+    } else {
+        encodedData = withVectorWord(params.n, [&]<VectorWord T>() {
+            return sendEncoded<T>(imageSpan, params, p, channel);
+        });
     }
+    stbi_image_free(imageData);
 
     // get image paths
     std::filesystem::path path(imagePath);
@@ -60,9 +81,7 @@ void imageEncodingStart(const CommonParams& params) {
     std::string unencodedPath = path.replace_filename(stem + "-unencoded.bmp").string();
     std::string encodedPath = path.replace_filename(stem + "-encoded.bmp").string();
 
-    // convert vectors to images
-    std::vector<uint8_t> unencodedData = vectorsToData(receivedUnencodedVectors, params.k, lastVectorPadding);
-    std::vector<uint8_t> encodedData = vectorsToData(decodedVectors, params.k, lastVectorPadding);
+    // save images
     stbi_write_bmp(unencodedPath.c_str(), width, height, channels, unencodedData.data());
     std::print("Paveikslelis be uzkodavimo issaugotas '{}'\n", unencodedPath);
     stbi_write_bmp(encodedPath.c_str(), width, height, channels, encodedData.data());
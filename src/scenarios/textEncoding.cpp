@@ -4,6 +4,34 @@
 #include "../math.h"
 #include "../encoder.h"
 
+#include <ranges>
+#include <vector>
+
+// number of vectors decoded at once, so batch decoding gets enough vectors to fill its SIMD lanes
+constexpr size_t decodeChunkSize = 4096;
+
+// Lazily decodes vectors in chunks with batch decoding and yields them one at a time.
+// template args:
+//   V - view of received vectors.
+// args:
+//   received - received vectors.
+//   params - common parameters.
+// returns:
+//   std::generator<vec> - decoded vectors.
+template <std::ranges::view V>
+static std::generator<vec> lazyDecodeVectors(V received, const CommonParams& params) {
+    std::vector<vec> chunk;
+    chunk.reserve(decodeChunkSize);
+    auto it = std::ranges::begin(received);
+    auto end = std::ranges::end(received);
+    while (it != end) {
+        chunk.clear();
+        for (; it != end && chunk.size() < decodeChunkSize; ++it) chunk.push_back(*it);
+        decodeVectors(chunk, params);
+        for (vec v : chunk) co_yield v;
+    }
+}
+
 void textEncodingStart(const CommonParams& params) {
     double p = userInputNumber<double>("Iveskite klaidos tikimybe p: ", 0.0, 1.0);
     Channel channel;
@@ -19,27 +47,20 @@ void textEncodingStart(const CommonParams& params) {
         v = channel.sendVector(v, params.k, p);
     }
 
-    // encode vectors
-    std::vector<vec> encodedVectors = originalVectors;
-    for (auto& v : encodedVectors) {
-        v = encode(v, params.gTransposed);
-    }
-
-    // send through channel encoded vectors
-    std::vector<vec> receivedEncodedVectors = encodedVectors;
-    for (auto& v : receivedEncodedVectors) {
-        v = channel.sendVector(v, params.n, p);
-    }
-
-    // decode received vectors
-    std::vector<vec> decodedVectors = receivedEncodedVectors;
-    for (auto& v : decodedVectors) {
-        v = decode(v, params.syndromes, params.h);
+    // encode, send through channel and convert back to text one vector at a time, decode a chunk at a time
+    std::span<const uint8_t> inputBytes = { reinterpret_cast<const uint8_t*>(inputText.data()), inputText.size() };
+    auto receivedVectors = lazyVectorsFromData(inputBytes, params.k)
+        | std::views::transform([&](vec v) { return encode(v, params); })
+        | std::views::transform([&](vec v) { return channel.sendVector(v, params.n, p); });
+    std::generator<vec> decodedVectors = lazyDecodeVectors(std::move(receivedVectors), params);
+    std::string encodedText;
+    encodedText.reserve(inputText.size());
+    for (uint8_t byte : lazyVectorsToData(std::move(decodedVectors), params.k, lastVectorPadding)) {
+        encodedText.push_back(static_cast<char>(byte));
     }
 
     // convert vectors back to text
     std::string unencodedText = vectorsToString(receivedUnencodedVectors, params.k, lastVectorPadding);
-    std::string encodedText = vectorsToString(decodedVectors, params.k, lastVectorPadding);
 
     // print results
     size_t unencodedErrorCount = 0;
@@ -10,7 +10,7 @@ void vectorEncodingStart(const CommonParams& params) {
 
     // input vector and encode it
     vec originalVector = userInputVector("Iveskite vektoriu", params.k);
-    vec encodedVector = encode(originalVector, params.gTransposed);
+    vec encodedVector = encode(originalVector, params);
     std::print("Uzkoduotas vektorius: {}\n", printVec(encodedVector, params.n));
 
     // send through channel
@@ -40,7 +40,7 @@ void vectorEncodingStart(const CommonParams& params) {
     }
 
     // decode received vector
-    vec decodedVector = decode(receivedVector, params.syndromes, params.h);
+    vec decodedVector = decode(receivedVector, params);
     std::print("Originalus vektorius: {}\n", printVec(originalVector, params.k));
     std::print("Dekoduotas vektorius: {}\n", printVec(decodedVector, params.k));
 }
\ No newline at end of file
@@ -0,0 +1,343 @@
+#include "server.h"
+
+#include <print>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include "io.h"
+
+#ifdef __linux__
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+
+// requests with more vectors than this are rejected, so a broken client can't exhaust memory
+constexpr uint64_t maxRequestCount = 1ULL << 24;
+// while requests wait for syndromes, event loop checks them this often
+constexpr int syndromePollMs = 10;
+
+struct Client {
+    std::vector<uint8_t> in; // received bytes that don't form a full request yet
+    std::vector<uint8_t> out; // response bytes not sent yet
+    size_t outOffset = 0;
+    bool closing = false; // peer closed connection or sent invalid data
+    bool hungUp = false; // peer can't receive responses anymore
+};
+
+struct Request {
+    int fd;
+    RequestHeader header;
+    std::vector<vec> payload;
+    ResponseHeader response;
+    bool deferred = false; // waits until syndromes of its code (or of an earlier request on the same connection) are generated
+};
+
+// Registered codes. Same code registered twice gets the same id.
+struct CodeRegistry {
+    std::vector<CommonParams> codes;
+    std::map<std::vector<vec>, uint32_t> ids; // (n, k, rows of A) -> code id
+};
+
+// Registers code from request payload (n, k, rows of A).
+// Syndromes are generated in background, so a big code doesn't stop the server for other clients.
+// args:
+//   registry - registered codes.
+//   payload - request payload.
+//   response - response header to fill.
+static void registerCode(CodeRegistry& registry, const std::vector<vec>& payload, ResponseHeader& response) {
+    response = { ResponseStatus::badRequest, 0, 0 };
+    if (payload.size() < 2) return;
+    size_t n = payload[0];
+    size_t k = payload[1];
+    if (n < 2 || n > 64 || k < 1 || k >= n || n - k > maxSyndromeBits || payload.size() != k + 2) return;
+
+    auto it = registry.ids.find(payload);
+    if (it != registry.ids.end()) {
+        response = { ResponseStatus::ok, it->second, 0 };
+        return;
+    }
+
+    matrix a(k, n - k);
+    vec rowMask = n - k == 64 ? ~vec{0} : (1ULL << (n - k)) - 1;
+    for (size_t r = 0; r < k; r++) {
+        a.data()[r] = payload[r + 2] & rowMask;
+    }
+    std::print("Registruojamas kodas n={}, k={}, sindromai generuojami fone ...\n", n, k);
+    registry.codes.push_back(makeCommonParams(n, k, a, false));
+    uint32_t id = static_cast<uint32_t>(registry.codes.size() - 1);
+    registry.ids[payload] = id;
+    response = { ResponseStatus::ok, id, 0 };
+}
+
+// Checks if syndromes of a code are generated.
+// args:
+//   params - code parameters.
+//   failed - gets set to true if generation failed (e.g. not enough memory).
+// returns:
+//   bool - true if generation is finished (successfully or not).
+static bool syndromesReady(const CommonParams& params, bool& failed) {
+    failed = false;
+    if (!params.syndromes->ready()) return false;
+    try {
+        params.syndromes->get();
+    } catch (...) {
+        failed = true;
+    }
+    return true;
+}
+
+// Processes all requests received in one event loop iteration.
+// Encode and decode requests for the same code are concatenated and run through the kernels once.
+// Requests for codes whose syndromes are still being generated are deferred, together with all later requests
+// on the same connection, so responses stay in order.
+// args:
+//   registry - registered codes.
+//   requests - requests to process. Payloads are replaced with results, deferred requests are left as they are.
+static void processRequests(CodeRegistry& registry, std::vector<Request>& requests) {
+    std::vector<int> waitingFds; // connections with a deferred request
+    // registrations first, in order of arrival
+    for (Request& req : requests) {
+        bool failed = false;
+        bool knownCode = req.header.codeId < registry.codes.size();
+        bool waits = std::find(waitingFds.begin(), waitingFds.end(), req.fd) != waitingFds.end();
+        if (!waits && knownCode && req.header.type == RequestType::decode) {
+            waits = !syndromesReady(registry.codes[req.header.codeId], failed);
+        }
+        req.deferred = waits;
+        if (waits) {
+            waitingFds.push_back(req.fd);
+        } else if (req.header.type == RequestType::registerCode) {
+            registerCode(registry, req.payload, req.response);
+            req.payload.clear();
+        } else if (req.header.type != RequestType::encode && req.header.type != RequestType::decode) {
+            req.response = { ResponseStatus::badRequest, req.header.codeId, 0 };
+            req.payload.clear();
+        } else if (!knownCode) {
+            req.response = { ResponseStatus::unknownCode, req.header.codeId, 0 };
+            req.payload.clear();
+        } else if (failed) {
+            req.response = { ResponseStatus::badRequest, req.header.codeId, 0 };
+            req.payload.clear();
+        } else {
+            req.response = { ResponseStatus::ok, req.header.codeId, req.payload.size() };
+        }
+    }
+
+    std::vector<vec> buffer;
+    for (uint32_t id = 0; id < registry.codes.size(); id++) {
+        const CommonParams& params = registry.codes[id];
+        for (RequestType type : { RequestType::encode, RequestType::decode }) {
+            // gather vectors of all matching requests into one buffer
+            buffer.clear();
+            size_t bits = type == RequestType::encode ? params.k : params.n;
+            vec mask = bits == 64 ? ~vec{0} : (1ULL << bits) - 1;
+            for (const Request& req : requests) {
+                if (req.deferred || req.header.type != type || req.header.codeId != id || req.response.status != ResponseStatus::ok) continue;
+                for (vec v : req.payload) buffer.push_back(v & mask);
+            }
+            if (buffer.empty()) continue;
+
+            if (type == RequestType::encode) {
+                for (vec& v : buffer) v = encode(v, params);
+            } else {
+                decodeVectors(buffer, params);
+            }
+
+            // scatter results back
+            size_t offset = 0;
+            for (Request& req : requests) {
+                if (req.deferred || req.header.type != type || req.header.codeId != id || req.response.status != ResponseStatus::ok) continue;
+                std::copy_n(buffer.begin() + offset, req.payload.size(), req.payload.begin());
+                offset += req.payload.size();
+            }
+        }
+    }
+}
+
+// Appends bytes of a value to buffer.
+template <typename T>
+static void appendBytes(std::vector<uint8_t>& buffer, const T* data, size_t count) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T) * count);
+}
+
+// Splits received bytes into requests. Incomplete request is left in client buffer.
+// args:
+//   fd - client socket.
+//   client - client state.
+//   requests - parsed requests are appended here.
+static void parseRequests(int fd, Client& client, std::vector<Request>& requests) {
+    size_t offset = 0;
+    while (client.in.size() - offset >= sizeof(RequestHeader)) {
+        RequestHeader header;
+        std::memcpy(&header, client.in.data() + offset, sizeof(header));
+        if (header.count > maxRequestCount) {
+            ResponseHeader response = { ResponseStatus::badRequest, header.codeId, 0 };
+            appendBytes(client.out, &response, 1);
+            client.closing = true;
+            offset = client.in.size();
+            break;
+        }
+
+        size_t size = sizeof(RequestHeader) + header.count * sizeof(vec);
+        if (client.in.size() - offset < size) break;
+
+        Request req{ fd, header, std::vector<vec>(header.count), {} };
+        std::memcpy(req.payload.data(), client.in.data() + offset + sizeof(RequestHeader), header.count * sizeof(vec));
+        requests.push_back(std::move(req));
+        offset += size;
+    }
+    client.in.erase(client.in.begin(), client.in.begin() + offset);
+}
+
+// Sends as much of pending output as socket accepts.
+// returns:
+//   bool - false if connection is broken.
+static bool flushClient(int fd, Client& client) {
+    while (client.outOffset < client.out.size()) {
+        ssize_t sent = send(fd, client.out.data() + client.outOffset, client.out.size() - client.outOffset, MSG_NOSIGNAL);
+        if (sent < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+        client.outOffset += sent;
+    }
+    client.out.clear();
+    client.outOffset = 0;
+    return true;
+}
+
+int runServer(std::string_view socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::print("Klaida! Per ilgas lizdo kelias.\n");
+        return 1;
+    }
+    std::memcpy(address.sun_path, socketPath.data(), socketPath.size());
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(address.sun_path);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listenFd, SOMAXCONN) < 0) {
+        std::print("Klaida! Nepavyko atidaryti lizdo '{}': {}\n", socketPath, std::strerror(errno));
+        return 1;
+    }
+
+    // SIGINT and SIGTERM are handled in the event loop
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    int signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = signalFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event);
+
+    std::print("Serveris laukia uzklausu '{}'\n", socketPath);
+
+    CodeRegistry registry;
+    std::unordered_map<int, Client> clients;
+    std::vector<Request> requests;
+    std::vector<int> touched; // clients that got events or responses in this iteration
+    std::vector<uint8_t> readBuffer(1 << 16);
+    epoll_event events[64];
+    bool running = true;
+    while (running) {
+        // deferred requests are left in 'requests', wake up to check if their syndromes are ready
+        int ready = epoll_wait(epollFd, events, std::size(events), requests.empty() ? -1 : syndromePollMs);
+        if (ready < 0 && errno != EINTR) break;
+
+        for (int e = 0; e < ready; e++) {
+            int fd = events[e].data.fd;
+            if (fd == signalFd) {
+                running = false;
+            } else if (fd == listenFd) {
+                int clientFd;
+                while ((clientFd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    event.events = EPOLLIN;
+                    event.data.fd = clientFd;
+                    epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &event);
+                    clients[clientFd] = {};
+                }
+            } else {
+                Client& client = clients[fd];
+                touched.push_back(fd);
+                client.hungUp = client.hungUp || (events[e].events & (EPOLLHUP | EPOLLERR));
+                if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    while (true) {
+                        ssize_t received = recv(fd, readBuffer.data(), readBuffer.size(), 0);
+                        if (received > 0) {
+                            client.in.insert(client.in.end(), readBuffer.begin(), readBuffer.begin() + received);
+                            continue;
+                        }
+                        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) client.closing = true;
+                        break;
+                    }
+                    parseRequests(fd, client, requests);
+                }
+            }
+        }
+
+        processRequests(registry, requests);
+        for (const Request& req : requests) {
+            if (req.deferred) continue;
+            Client& client = clients[req.fd];
+            ResponseHeader response = req.response;
+            response.count = req.response.status == ResponseStatus::ok ? req.payload.size() : 0;
+            appendBytes(client.out, &response, 1);
+            appendBytes(client.out, req.payload.data(), response.count);
+            touched.push_back(req.fd);
+        }
+        std::erase_if(requests, [](const Request& req) { return !req.deferred; });
+
+        // send responses, wait for EPOLLOUT if socket is full
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        for (int fd : touched) {
+            Client& client = clients[fd];
+            bool alive = flushClient(fd, client);
+            bool waiting = std::any_of(requests.begin(), requests.end(), [&](const Request& req) { return req.fd == fd; });
+            if (!alive || client.hungUp || (client.closing && client.out.empty() && !waiting)) {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+                close(fd);
+                clients.erase(fd);
+                std::erase_if(requests, [&](const Request& req) { return req.fd == fd; });
+                continue;
+            }
+            // closing client has nothing more to read, and EPOLLIN would be reported on every wait while it waits for responses
+            event.events = (client.closing ? 0u : uint32_t{EPOLLIN}) | (client.out.empty() ? 0u : uint32_t{EPOLLOUT});
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+        }
+        touched.clear();
+    }
+
+    for (auto& [fd, client] : clients) close(fd);
+    close(epollFd);
+    close(signalFd);
+    close(listenFd);
+    unlink(address.sun_path);
+    std::print("Serveris sustabdytas\n");
+    return 0;
+}
+
+#else
+
+int runServer(std::string_view) {
+    std::print("Klaida! Serverio rezimas veikia tik Linux sistemoje.\n");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <string_view>
+
+// Server mode keeps parameters (G, H, syndromes) of registered codes in memory
+// and answers encode/decode requests over a Unix domain socket.
+//
+// Every message starts with a header, followed by 'count' 64-bit words (host byte order).
+// Requests use RequestHeader, responses use ResponseHeader. Requests on one connection are answered in order.
+//   register: payload is n, k and k rows of matrix part A (count = k + 2), k < n, n-k at most maxSyndromeBits.
+//             Response codeId identifies the code. Syndromes are generated in background, decode requests wait for them.
+//   encode:   payload is count vectors of k bits. Response has count encoded vectors of n bits.
+//   decode:   payload is count vectors of n bits. Response has count decoded vectors of k bits.
+// Requests that arrive together are batched, so all vectors for the same code go through one decodeBatch call.
+
+enum class RequestType : uint32_t {
+    registerCode = 1,
+    encode = 2,
+    decode = 3,
+};
+
+enum class ResponseStatus : uint32_t {
+    ok = 0,
+    badRequest = 1, // unknown request type or invalid code parameters
+    unknownCode = 2,
+};
+
+struct RequestHeader {
+    RequestType type;
+    uint32_t codeId;
+    uint64_t count;
+};
+
+struct ResponseHeader {
+    ResponseStatus status;
+    uint32_t codeId;
+    uint64_t count;
+};
+
+// Default socket path used if none is given.
+constexpr std::string_view defaultSocketPath = "/tmp/kodavimas.sock";
+
+// Runs server until it gets SIGINT or SIGTERM.
+// args:
+//   socketPath - path of Unix domain socket to listen on.
+// returns:
+//   int - exit code (0 on success).
+int runServer(std::string_view socketPath);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <bit>
+#include <algorithm>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// template args:
+//   T - type of stored elements. Elements are moved in and out of the queue.
+template <typename T>
+class SpscQueue {
+public:
+    // Constructs an empty queue.
+    // args:
+    //   capacity - maximum number of elements in queue. Rounded up to a power of 2.
+    explicit SpscQueue(size_t capacity)
+        :   m_slots(std::bit_ceil(std::max<size_t>(capacity, 1))),
+            m_mask(m_slots.size() - 1) {}
+
+    // Tries to add element to queue. Only called by producer.
+    // args:
+    //   value - element to add. Moved from if push succeeds.
+    // returns:
+    //   bool - false if queue is full.
+    bool tryPush(T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_slots.size()) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == m_slots.size()) return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Tries to take element from queue. Only called by consumer.
+    // args:
+    //   value - gets set to taken element.
+    // returns:
+    //   bool - false if queue is empty.
+    bool tryPop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) return false;
+        }
+        value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Adds element to queue, waits while queue is full. Only called by producer.
+    // args:
+    //   value - element to add.
+    void push(T value) {
+        while (!tryPush(value)) std::this_thread::yield();
+    }
+
+    // Takes element from queue, waits while queue is empty. Only called by consumer.
+    // returns:
+    //   T - taken element.
+    T pop() {
+        T value;
+        while (!tryPop(value)) std::this_thread::yield();
+        return value;
+    }
+
+    // Returns number of elements in queue. Can be called from any thread, result is approximate.
+    // returns:
+    //   size_t - number of elements in queue.
+    size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    // Returns maximum number of elements in queue.
+    // returns:
+    //   size_t - capacity of queue.
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    std::vector<T> m_slots;
+    size_t m_mask;
+    // producer and consumer data are kept on separate cache lines
+    alignas(64) std::atomic<size_t> m_head = 0; // next slot to pop, written by consumer
+    size_t m_cachedTail = 0; // consumer's copy of m_tail
+    alignas(64) std::atomic<size_t> m_tail = 0; // next slot to push, written by producer
+    size_t m_cachedHead = 0; // producer's copy of m_head
+};